@@ -15,8 +15,9 @@ ostream& dbg(LogLevel level)
     }
     else
     {
-        // no-op stream
-        static ostream null_stream{nullptr};
+        // no-op stream; writes to it still update its state, so each
+        // thread gets its own to keep parallel solutions race-free.
+        thread_local ostream null_stream{nullptr};
         return null_stream;
     }
 }
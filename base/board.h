@@ -2,20 +2,37 @@
 
 #include "point.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <iostream>
 #include <ranges>
+#include <stdexcept>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
+/**
+ * @brief A rectangular grid of cells, addressed by Point.
+ *
+ * Cells are stored in a single row-major buffer.  A board may optionally
+ * be surrounded by a border of `padding` extra cells on every side, all
+ * holding a fixed value.  Points in the border are never in_bounds(), but
+ * can still be read with at() and operator[], so a scan over an interior
+ * cell's neighbors needs no bounds checks at all.
+ *
+ * Cells can also be addressed by their index into the buffer - see
+ * index_of(), point_of() and stride() - which is handy for algorithms
+ * that want flat per-cell arrays of their own.
+ */
 template <typename T>
 class BasicBoard
 {
-    std::vector<std::vector<T>> contents_;
+    std::vector<T> contents_;
     int num_rows_;
     int num_cols_;
+    int padding_;
 
     template <typename U>
     friend std::ostream& operator<<(std::ostream& os, const BasicBoard<U>& board);
@@ -28,19 +45,41 @@ public:
         : contents_{}
         , num_rows_{0}
         , num_cols_{0}
+        , padding_{0}
     {}
 
-    BasicBoard(const std::vector<std::vector<T>>& contents)
-        : contents_(contents)
-        , num_rows_(static_cast<int>(contents.size()))
-        , num_cols_(static_cast<int>(contents[0].size()))
-    {}
+    BasicBoard(int num_rows, int num_cols, const T& value, int padding = 0, const T& border = T{})
+        : contents_{}
+        , num_rows_{num_rows}
+        , num_cols_{num_cols}
+        , padding_{padding}
+    {
+        contents_.resize(buffer_size(), border);
+        for (int y = 0; y < num_rows_; ++y)
+        {
+            auto row = contents_.begin() + static_cast<std::ptrdiff_t>(index_of({0, y}));
+            std::fill(row, row + num_cols_, value);
+        }
+    }
 
-    BasicBoard(std::vector<std::vector<T>>&& contents)
-        : contents_(contents)
-        , num_rows_(static_cast<int>(contents.size()))
-        , num_cols_(static_cast<int>(contents[0].size()))
-    {}
+    BasicBoard(const std::vector<std::vector<T>>& contents, int padding = 0, const T& border = T{})
+        : contents_{}
+        , num_rows_{static_cast<int>(contents.size())}
+        , num_cols_{contents.empty() ? 0 : static_cast<int>(contents[0].size())}
+        , padding_{padding}
+    {
+        contents_.resize(buffer_size(), border);
+        for (int y = 0; y < num_rows_; ++y)
+        {
+            const auto& line = contents[static_cast<size_t>(y)];
+            if (line.size() != static_cast<size_t>(num_cols_))
+            {
+                throw std::runtime_error("ragged board: row " + std::to_string(y) + " has "
+                    + std::to_string(line.size()) + " cells, expected " + std::to_string(num_cols_));
+            }
+            std::copy(line.begin(), line.end(), contents_.begin() + static_cast<std::ptrdiff_t>(index_of({0, y})));
+        }
+    }
 
     BasicBoard(const BasicBoard&) = default;
     BasicBoard(BasicBoard&&) noexcept = default;
@@ -48,6 +87,22 @@ public:
     BasicBoard& operator=(const BasicBoard&) = default;
     BasicBoard& operator=(BasicBoard&&) noexcept = default;
 
+    /**
+     * @brief Returns a copy of this board surrounded by `padding` cells of
+     *        `border` on every side.
+     */
+    BasicBoard with_border(int padding, const T& border) const
+    {
+        BasicBoard result{num_rows_, num_cols_, T{}, padding, border};
+        for (int y = 0; y < num_rows_; ++y)
+        {
+            auto src = contents_.begin() + static_cast<std::ptrdiff_t>(index_of({0, y}));
+            auto dst = result.contents_.begin() + static_cast<std::ptrdiff_t>(result.index_of({0, y}));
+            std::copy_n(src, num_cols_, dst);
+        }
+        return result;
+    }
+
     int num_rows() const
     {
         return num_rows_;
@@ -58,32 +113,69 @@ public:
         return num_cols_;
     }
 
+    int padding() const
+    {
+        return padding_;
+    }
+
+    /**
+     * @brief The distance between vertically-adjacent cells in the buffer.
+     */
+    int stride() const
+    {
+        return num_cols_ + 2 * padding_;
+    }
+
+    /**
+     * @brief The number of cells in the buffer, including the border.
+     */
+    std::size_t buffer_size() const
+    {
+        return static_cast<std::size_t>(num_rows_ + 2 * padding_) * static_cast<std::size_t>(stride());
+    }
+
+    std::size_t index_of(Point p) const
+    {
+        assert(p.x() >= -padding_ && p.x() < num_cols_ + padding_);
+        assert(p.y() >= -padding_ && p.y() < num_rows_ + padding_);
+        return static_cast<std::size_t>(p.y() + padding_) * static_cast<std::size_t>(stride())
+            + static_cast<std::size_t>(p.x() + padding_);
+    }
+
+    Point point_of(std::size_t index) const
+    {
+        int i = static_cast<int>(index);
+        return {i % stride() - padding_, i / stride() - padding_};
+    }
+
     T at(const Point& p) const
     {
-        assert(p.x() >= 0);
-        assert(p.y() >= 0);
-        return contents_[static_cast<size_t>(p.y())][static_cast<size_t>(p.x())];
+        return contents_[index_of(p)];
     }
 
     T& at(const Point& p)
     {
-        assert(p.x() >= 0);
-        assert(p.y() >= 0);
-        return contents_[static_cast<size_t>(p.y())][static_cast<size_t>(p.x())];
+        return contents_[index_of(p)];
     }
 
     const T& operator[](const Point& p) const
     {
-        assert(p.x() >= 0);
-        assert(p.y() >= 0);
-        return contents_[static_cast<size_t>(p.y())][static_cast<size_t>(p.x())];
+        return contents_[index_of(p)];
     }
 
     T& operator[](const Point& p)
     {
-        assert(p.x() >= 0);
-        assert(p.y() >= 0);
-        return contents_[static_cast<size_t>(p.y())][static_cast<size_t>(p.x())];
+        return contents_[index_of(p)];
+    }
+
+    const T& operator[](std::size_t index) const
+    {
+        return contents_[index];
+    }
+
+    T& operator[](std::size_t index)
+    {
+        return contents_[index];
     }
 
     bool in_bounds(Point p) const
@@ -150,14 +242,14 @@ std::istream& operator>>(std::istream& in, BasicBoard<T>& board)
 {
     in >> std::ws;
 
+    std::vector<std::vector<T>> lines;
     std::string line;
     while (getline(in, line) && !line.empty())
     {
-        board.contents_.emplace_back(line.begin(), line.end());
+        lines.emplace_back(line.begin(), line.end());
     }
 
-    board.num_rows_ = static_cast<int>(board.contents_.size());
-    board.num_cols_ = static_cast<int>(board.contents_[0].size());
+    board = BasicBoard<T>{lines};
 
     return in;
 }
@@ -1,8 +1,21 @@
 #pragma once
 
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -13,16 +26,74 @@ public:
     virtual bool contains(const std::string& word) const = 0;
 };
 
+/**
+ * @brief An alphabet maps characters to dense column indices.
+ *
+ * `index_of(c)` returns a value in [0, size), or `size` if c is not in the
+ * alphabet.  Words are ordered by their sequence of indices, which is the
+ * order DawgBuilder expects them in.
+ */
+template <typename A>
+concept DawgAlphabet = requires(char c)
+{
+    { A::size } -> std::convertible_to<std::size_t>;
+    { A::index_of(c) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * @brief The English alphabet, case-insensitively.
+ */
+struct LowercaseAlphabet
+{
+    static constexpr std::size_t size = 26;
+
+    static constexpr std::size_t index_of(char c)
+    {
+        if (c >= 'A' && c <= 'Z')
+        {
+            return static_cast<std::size_t>(c - 'A');
+        }
+
+        if (c >= 'a' && c <= 'z')
+        {
+            return static_cast<std::size_t>(c - 'a');
+        }
+
+        return size;
+    }
+};
+
+/**
+ * @brief Every byte value, as-is.
+ */
+struct ByteAlphabet
+{
+    static constexpr std::size_t size = 256;
+
+    static constexpr std::size_t index_of(char c)
+    {
+        return static_cast<unsigned char>(c);
+    }
+};
+
 /**
  * @brief A Directed Acyclic Word Graph (DAWG) implementation.
  *
- * It is specialized for the English lowercase alphabet only - no spaces,
- * numbers, or punctuation.
+ * It is specialized for a fixed `Alphabet`; any other character simply
+ * has no successor.  `Index` is the width of a node id, and caps the graph
+ * at numeric_limits<Index>::max() nodes.
+ *
+ * Representation here is a 2D array of Index.  Each row is
+ * Alphabet::size + 1 elements wide, and represents one conceptual node of
+ * the graph.  The first Alphabet::size elements identify the successor
+ * node for the given character, and the final element is an end-of-word
+ * bit.  Row 0 is a dead node with no successors, so 0 means "no such
+ * node", and walking on from it is safe.
  *
- * Representation here is a 2D array of 16-bit integers.  Each row is 27
- * elements wide, and represents one conceptual node of the graph.  The
- * first 26 elements identify the successor node for the given character,
- * and the final element is an end-of-word bit.
+ * The rows are either owned, or live in a file written by save() and
+ * memory-mapped by load(), so that opening a prebuilt dictionary costs one
+ * validating pass over it rather than a rebuild or a copy.  Files use the
+ * machine's native byte order.
  *
  * It implements IWordSet for easy use, but also exposes a lower-level API
  * for working directly with nodes.
@@ -30,36 +101,401 @@ public:
  * This is more expensive to build than a Trie or a set, but has great memory
  * locality and is very fast to query.
  */
-class Dawg : public IWordSet
+template <DawgAlphabet Alphabet, std::unsigned_integral Index>
+class BasicDawg : public IWordSet
 {
-    std::vector<std::uint16_t> trie_;
-    std::uint16_t root_;
+public:
+    using Node = Index;
+
+    static constexpr std::size_t kRowSize = Alphabet::size + 1;
+
+private:
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t alphabet_size;
+        std::uint32_t index_width;
+        std::uint32_t reserved;
+        std::uint64_t num_nodes;
+        std::uint64_t root;
+    };
+
+    static constexpr char kMagic[8] = {'A', 'O', 'C', 'D', 'A', 'W', 'G', '\0'};
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::vector<Index> owned_;
+    std::optional<MappedFile> file_;
+    const Index* rows_;
+    std::size_t num_nodes_;
+    Index root_;
 
 public:
-    Dawg(std::vector<std::uint16_t>&& trie, std::uint16_t root);
-    virtual ~Dawg() = default;
+    BasicDawg(std::vector<Index>&& rows, Index root)
+        : owned_(std::move(rows))
+        , file_()
+        , rows_(owned_.data())
+        , num_nodes_(owned_.size() / kRowSize)
+        , root_(root)
+    {}
+
+    // Moving a vector or a MappedFile leaves the underlying buffer where
+    // it was, so rows_ stays valid.
+    BasicDawg(BasicDawg&&) noexcept = default;
+    BasicDawg& operator=(BasicDawg&&) noexcept = default;
+
+    BasicDawg(const BasicDawg&) = delete;
+    BasicDawg& operator=(const BasicDawg&) = delete;
+
+    virtual ~BasicDawg() = default;
+
+    /**
+     * @brief Maps a file written by save().
+     *
+     * Every row is checked on the way in, so a corrupt file is rejected
+     * here rather than read out of bounds by a later query.
+     *
+     * @throws std::runtime_error if the file can't be mapped, wasn't
+     *         written for this alphabet and index width, or is corrupt.
+     */
+    static BasicDawg load(const std::string& path)
+    {
+        MappedFile file{path};
+        auto contents = file.contents();
+
+        FileHeader header;
+        if (contents.size() < sizeof(header))
+        {
+            throw std::runtime_error("not a dawg: " + path);
+        }
+        std::memcpy(&header, contents.data(), sizeof(header));
+
+        if (!std::equal(std::begin(kMagic), std::end(kMagic), header.magic) || header.version != kVersion)
+        {
+            throw std::runtime_error("not a dawg: " + path);
+        }
+
+        if (header.alphabet_size != Alphabet::size || header.index_width != sizeof(Index))
+        {
+            throw std::runtime_error("dawg has the wrong alphabet or index width: " + path);
+        }
+
+        // Derive the node count from the file's size rather than multiplying
+        // the header's count out, which could overflow.
+        constexpr std::size_t kRowBytes = kRowSize * sizeof(Index);
+        std::size_t body = contents.size() - sizeof(header);
+        if (header.num_nodes == 0
+            || header.root >= header.num_nodes
+            || body % kRowBytes != 0
+            || body / kRowBytes != header.num_nodes)
+        {
+            throw std::runtime_error("truncated or corrupt dawg: " + path);
+        }
+
+        // The mapping is page-aligned and the header is a multiple of 8
+        // bytes, so the rows are suitably aligned for Index.
+        auto rows = reinterpret_cast<const Index*>(contents.data() + sizeof(header));
+        for (std::size_t i = 0; i < header.num_nodes * kRowSize; ++i)
+        {
+            bool is_eow = i % kRowSize == Alphabet::size;
+            if (is_eow ? rows[i] > 1 : rows[i] >= header.num_nodes)
+            {
+                throw std::runtime_error("truncated or corrupt dawg: " + path);
+            }
+        }
+        return BasicDawg{std::move(file), rows, static_cast<std::size_t>(header.num_nodes), static_cast<Index>(header.root)};
+    }
+
+    /**
+     * @brief Writes the graph to `path`, in the format load() maps.
+     */
+    void save(const std::string& path) const
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+        FileHeader header{};
+        std::copy(std::begin(kMagic), std::end(kMagic), header.magic);
+        header.version = kVersion;
+        header.alphabet_size = static_cast<std::uint32_t>(Alphabet::size);
+        header.index_width = sizeof(Index);
+        header.num_nodes = num_nodes_;
+        header.root = root_;
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(rows_), static_cast<std::streamsize>(num_nodes_ * kRowSize * sizeof(Index)));
+        if (!out)
+        {
+            throw std::runtime_error("cannot write " + path);
+        }
+    }
 
     // High-level interface
-    bool contains(const std::string& word) const override;
+    bool contains(const std::string& word) const override
+    {
+        Index node = root_;
+        for (char c : word)
+        {
+            node = next(node, c);
+            if (node == 0)
+            {
+                return false;
+            }
+        }
+        return eow(node);
+    }
+
+    std::size_t num_nodes() const
+    {
+        return num_nodes_;
+    }
 
     // Low-level interface
 
     /**
      * @brief Returns the root node of the graph - queries start here.
-     *
-     * @return std::uint16_t
      */
-    std::uint16_t root() const;
+    Index root() const
+    {
+        return root_;
+    }
 
     /**
      * @brief Returns true if the given node is an end-of-word node.
      */
-    bool eow(std::uint16_t node) const;
+    bool eow(Index node) const
+    {
+        return rows_[node * kRowSize + Alphabet::size] == 1;
+    }
+
+    /**
+     * @brief Returns the successor node for the given node and character,
+     *        or 0 if there is none.
+     */
+    Index next(Index node, char c) const
+    {
+        std::size_t col = Alphabet::index_of(c);
+        if (col >= Alphabet::size)
+        {
+            return 0;
+        }
+        return rows_[node * kRowSize + col];
+    }
+
+private:
+    static_assert(sizeof(FileHeader) % 8 == 0);
+
+    BasicDawg(MappedFile&& file, const Index* rows, std::size_t num_nodes, Index root)
+        : owned_()
+        , file_(std::move(file))
+        , rows_(rows)
+        , num_nodes_(num_nodes)
+        , root_(root)
+    {}
+};
+
+/**
+ * @brief Builds a minimal BasicDawg incrementally, from words added in
+ *        sorted order (Daciuk et al.'s algorithm for sorted data).
+ *
+ * Only the path for the most recent word is ever unminimized.  When the
+ * next word diverges from it, the nodes below the divergence are frozen,
+ * merging each with an equivalent node already in the graph if there is
+ * one.  So the builder never holds more than the final graph plus one
+ * word's worth of nodes, and there is no intermediate trie.
+ */
+template <DawgAlphabet Alphabet, std::unsigned_integral Index>
+class DawgBuilder
+{
+    static constexpr std::size_t kRowSize = Alphabet::size + 1;
+    static constexpr Index kRoot = 1;
+
+    // Hashes and compares nodes by the contents of their rows.
+    struct RowHash
+    {
+        const std::vector<Index>* rows;
+
+        std::size_t operator()(Index node) const
+        {
+            std::size_t seed = 0;
+            for (std::size_t i = 0; i < kRowSize; ++i)
+            {
+                seed = (seed ^ (*rows)[node * kRowSize + i]) * 0x100000001B3ull;
+            }
+            return seed;
+        }
+    };
+
+    struct RowEqual
+    {
+        const std::vector<Index>* rows;
+
+        bool operator()(Index a, Index b) const
+        {
+            auto begin = rows->begin();
+            return std::equal(
+                begin + static_cast<std::ptrdiff_t>(a * kRowSize),
+                begin + static_cast<std::ptrdiff_t>((a + 1) * kRowSize),
+                begin + static_cast<std::ptrdiff_t>(b * kRowSize)
+            );
+        }
+    };
+
+    struct Edge
+    {
+        Index parent;
+        std::size_t col;
+        Index child;
+    };
+
+    std::vector<Index> rows_;
+    std::unordered_set<Index, RowHash, RowEqual> register_;
+    std::vector<Index> free_;
+    std::vector<Edge> unchecked_;
+    std::vector<std::size_t> previous_;
+
+public:
+    DawgBuilder()
+        : rows_(2 * kRowSize, 0) // the dead node, then the root
+        , register_(0, RowHash{&rows_}, RowEqual{&rows_})
+    {}
+
+    // The register points at rows_, so a builder can't be moved.
+    DawgBuilder(const DawgBuilder&) = delete;
+    DawgBuilder& operator=(const DawgBuilder&) = delete;
 
     /**
-     * @brief Returns the successor node for the given node and character.
+     * @brief Adds a word, which must not sort before the previous one.
+     *
+     * @throws std::invalid_argument if the word is out of order or has a
+     *         character outside the alphabet.
      */
-    std::uint16_t next(std::uint16_t node, char c) const;
+    void add(std::string_view word)
+    {
+        std::vector<std::size_t> cols;
+        cols.reserve(word.size());
+        for (char c : word)
+        {
+            std::size_t col = Alphabet::index_of(c);
+            if (col >= Alphabet::size)
+            {
+                throw std::invalid_argument("dawg words may not contain '" + std::string(1, c) + "'");
+            }
+            cols.push_back(col);
+        }
+
+        if (std::lexicographical_compare(cols.begin(), cols.end(), previous_.begin(), previous_.end()))
+        {
+            throw std::invalid_argument("dawg words must be added in order: " + std::string(word));
+        }
+
+        auto [mismatch, _] = std::mismatch(cols.begin(), cols.end(), previous_.begin(), previous_.end());
+        auto prefix = static_cast<std::size_t>(mismatch - cols.begin());
+        minimize(prefix);
+
+        Index node = unchecked_.empty() ? kRoot : unchecked_.back().child;
+        for (std::size_t i = prefix; i < cols.size(); ++i)
+        {
+            Index child = allocate();
+            rows_[node * kRowSize + cols[i]] = child;
+            unchecked_.push_back({node, cols[i], child});
+            node = child;
+        }
+        rows_[node * kRowSize + Alphabet::size] = 1;
+
+        previous_ = std::move(cols);
+    }
+
+    std::unique_ptr<BasicDawg<Alphabet, Index>> build()
+    {
+        minimize(0);
+
+        // Nodes that were merged away are still on the free list.  Move the
+        // highest-numbered live nodes into their slots, so the rows are
+        // contiguous.
+        std::sort(free_.begin(), free_.end());
+        std::vector<Index> renumber(rows_.size() / kRowSize);
+        for (std::size_t i = 0; i < renumber.size(); ++i)
+        {
+            renumber[i] = static_cast<Index>(i);
+        }
+
+        std::size_t last = renumber.size();
+        for (Index hole : free_)
+        {
+            while (last > hole && std::binary_search(free_.begin(), free_.end(), static_cast<Index>(last - 1)))
+            {
+                --last;
+            }
+            if (last <= hole)
+            {
+                break;
+            }
+
+            --last;
+            renumber[last] = hole;
+            std::copy_n(rows_.begin() + static_cast<std::ptrdiff_t>(last * kRowSize), kRowSize,
+                        rows_.begin() + static_cast<std::ptrdiff_t>(hole * kRowSize));
+        }
+        rows_.resize((renumber.size() - free_.size()) * kRowSize);
+
+        for (std::size_t i = 0; i < rows_.size(); ++i)
+        {
+            if (i % kRowSize != Alphabet::size)
+            {
+                rows_[i] = renumber[rows_[i]];
+            }
+        }
+
+        register_.clear();
+        free_.clear();
+        previous_.clear();
+        return std::make_unique<BasicDawg<Alphabet, Index>>(std::move(rows_), kRoot);
+    }
+
+private:
+    Index allocate()
+    {
+        if (!free_.empty())
+        {
+            Index node = free_.back();
+            free_.pop_back();
+            return node;
+        }
+
+        std::size_t node = rows_.size() / kRowSize;
+        if (node > std::numeric_limits<Index>::max())
+        {
+            throw std::length_error("too many nodes for this dawg's index width");
+        }
+        rows_.resize(rows_.size() + kRowSize, 0);
+        return static_cast<Index>(node);
+    }
+
+    // Freezes the unchecked path below depth `down_to`, deepest first.
+    void minimize(std::size_t down_to)
+    {
+        while (unchecked_.size() > down_to)
+        {
+            auto [parent, col, child] = unchecked_.back();
+            unchecked_.pop_back();
+
+            if (auto it = register_.find(child); it != register_.end())
+            {
+                rows_[parent * kRowSize + col] = *it;
+                std::fill_n(rows_.begin() + static_cast<std::ptrdiff_t>(child * kRowSize), kRowSize, Index{0});
+                free_.push_back(child);
+            }
+            else
+            {
+                register_.insert(child);
+            }
+        }
+    }
 };
 
+using Dawg = BasicDawg<LowercaseAlphabet, std::uint32_t>;
+
+/**
+ * @brief Builds a Dawg from words in any order.
+ */
 std::unique_ptr<Dawg> BuildDawg(const std::vector<std::string>& words);
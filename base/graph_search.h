@@ -0,0 +1,330 @@
+#pragma once
+
+#include "board.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Shortest-path search over graphs whose nodes are dense integers.
+ *
+ * Nodes are usually cell indices from BasicBoard::index_of(), or states
+ * built from them (e.g. cell * 4 + direction).  Per-node bookkeeping
+ * lives in flat arrays indexed by node, so there is no hashing anywhere
+ * on the hot path.
+ *
+ * Edges are supplied by a callable `neighbors(Node u, Emit emit)`, which
+ * calls `emit(Node v, Weight w)` once for each edge u -> v.
+ */
+namespace search
+{
+
+using Node = std::uint32_t;
+using Weight = std::uint32_t;
+
+constexpr Node kNoNode = std::numeric_limits<Node>::max();
+constexpr Weight kUnreachable = std::numeric_limits<Weight>::max();
+
+/**
+ * @brief A monotone priority queue for small integer weights (Dial's
+ *        algorithm).
+ *
+ * Keeps max_edge_weight + 1 buckets in a ring.  Every push must have a
+ * priority no lower than that of the last pop, and no more than
+ * max_edge_weight above it - which is exactly what Dijkstra does.
+ */
+class BucketQueue
+{
+    std::vector<std::vector<Node>> buckets_;
+    Weight current_;
+    std::size_t size_;
+
+public:
+    explicit BucketQueue(Weight max_edge_weight)
+        : buckets_(static_cast<std::size_t>(max_edge_weight) + 1)
+        , current_{0}
+        , size_{0}
+    {}
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    void push(Weight priority, Node node)
+    {
+        assert(priority >= current_ && priority - current_ < buckets_.size());
+        buckets_[priority % buckets_.size()].push_back(node);
+        size_++;
+    }
+
+    std::pair<Weight, Node> pop()
+    {
+        assert(!empty());
+        while (buckets_[current_ % buckets_.size()].empty())
+        {
+            current_++;
+        }
+
+        auto& bucket = buckets_[current_ % buckets_.size()];
+        Node node = bucket.back();
+        bucket.pop_back();
+        size_--;
+        return {current_, node};
+    }
+};
+
+enum class Predecessors
+{
+    // Remember one predecessor per node; enough to recover a shortest path.
+    ONE,
+
+    // Remember every predecessor on a shortest path, for "all shortest
+    // paths" queries.
+    ALL
+};
+
+class ShortestPaths;
+
+/**
+ * @brief Single- or multi-source Dijkstra over nodes [0, num_nodes).
+ *
+ * Every edge weight reported by `neighbors` must be at most
+ * max_edge_weight; unit-weight graphs (max_edge_weight = 1) make this a
+ * breadth-first search.
+ */
+template <typename Neighbors>
+ShortestPaths dijkstra(
+    std::size_t num_nodes,
+    const std::vector<Node>& sources,
+    Weight max_edge_weight,
+    Neighbors&& neighbors,
+    Predecessors mode = Predecessors::ONE);
+
+class ShortestPaths
+{
+    static constexpr std::uint32_t kNoLink = std::numeric_limits<std::uint32_t>::max();
+
+    struct Link
+    {
+        Node node;
+        std::uint32_t next;
+    };
+
+    std::vector<Weight> dist_;
+    std::vector<Node> prev_;
+
+    // With Predecessors::ALL, each node's predecessors form a linked list
+    // threaded through one shared pool, so ties cost no extra allocations.
+    std::vector<std::uint32_t> head_;
+    std::vector<Link> links_;
+
+    template <typename Neighbors>
+    friend ShortestPaths dijkstra(std::size_t, const std::vector<Node>&, Weight, Neighbors&&, Predecessors);
+
+public:
+    ShortestPaths(std::size_t num_nodes, Predecessors mode)
+        : dist_(num_nodes, kUnreachable)
+        , prev_(num_nodes, kNoNode)
+        , head_(mode == Predecessors::ALL ? num_nodes : 0, kNoLink)
+        , links_()
+    {}
+
+    Weight distance(Node n) const
+    {
+        return dist_[n];
+    }
+
+    bool reachable(Node n) const
+    {
+        return dist_[n] != kUnreachable;
+    }
+
+    /**
+     * @brief Returns one predecessor of n on a shortest path, or kNoNode
+     *        for sources and unreachable nodes.
+     */
+    Node predecessor(Node n) const
+    {
+        return prev_[n];
+    }
+
+    template <typename F>
+    void for_each_predecessor(Node n, F&& fn) const
+    {
+        if (head_.empty())
+        {
+            if (prev_[n] != kNoNode)
+            {
+                fn(prev_[n]);
+            }
+            return;
+        }
+
+        for (auto link = head_[n]; link != kNoLink; link = links_[link].next)
+        {
+            fn(links_[link].node);
+        }
+    }
+
+    /**
+     * @brief Returns the nodes of one shortest path from a source to
+     *        `target`, inclusive; empty if target is unreachable.
+     */
+    std::vector<Node> path_to(Node target) const
+    {
+        std::vector<Node> path;
+        if (!reachable(target))
+        {
+            return path;
+        }
+
+        for (Node n = target; n != kNoNode; n = prev_[n])
+        {
+            path.push_back(n);
+        }
+        return {path.rbegin(), path.rend()};
+    }
+
+    /**
+     * @brief Marks every node that lies on any shortest path from a source
+     *        to any of `targets`.  Requires Predecessors::ALL.
+     */
+    std::vector<bool> on_shortest_paths(const std::vector<Node>& targets) const
+    {
+        assert(!head_.empty());
+
+        std::vector<bool> marked(dist_.size(), false);
+        std::vector<Node> stack;
+        for (Node t : targets)
+        {
+            if (reachable(t) && !marked[t])
+            {
+                marked[t] = true;
+                stack.push_back(t);
+            }
+        }
+
+        while (!stack.empty())
+        {
+            Node n = stack.back();
+            stack.pop_back();
+
+            for_each_predecessor(n, [&](Node p) {
+                if (!marked[p])
+                {
+                    marked[p] = true;
+                    stack.push_back(p);
+                }
+            });
+        }
+
+        return marked;
+    }
+
+private:
+    void set_predecessor(Node n, Node pred)
+    {
+        prev_[n] = pred;
+        if (!head_.empty())
+        {
+            head_[n] = kNoLink;
+            add_predecessor(n, pred);
+        }
+    }
+
+    void add_predecessor(Node n, Node pred)
+    {
+        links_.push_back({pred, head_[n]});
+        head_[n] = static_cast<std::uint32_t>(links_.size() - 1);
+    }
+};
+
+template <typename Neighbors>
+ShortestPaths dijkstra(
+    std::size_t num_nodes,
+    const std::vector<Node>& sources,
+    Weight max_edge_weight,
+    Neighbors&& neighbors,
+    Predecessors mode)
+{
+    ShortestPaths sp{num_nodes, mode};
+    BucketQueue q{max_edge_weight};
+
+    for (Node s : sources)
+    {
+        sp.dist_[s] = 0;
+        q.push(0, s);
+    }
+
+    while (!q.empty())
+    {
+        auto [d, u] = q.pop();
+        if (d != sp.dist_[u])
+        {
+            // stale entry; u was reached more cheaply since this was queued
+            continue;
+        }
+
+        neighbors(u, [&](Node v, Weight w) {
+            assert(w <= max_edge_weight);
+
+            Weight alt = d + w;
+            if (alt < sp.dist_[v])
+            {
+                sp.dist_[v] = alt;
+                sp.set_predecessor(v, u);
+                q.push(alt, v);
+            }
+            else if (alt == sp.dist_[v] && mode == Predecessors::ALL)
+            {
+                sp.add_predecessor(v, u);
+            }
+        });
+    }
+
+    return sp;
+}
+
+template <typename Neighbors>
+ShortestPaths dijkstra(
+    std::size_t num_nodes,
+    Node source,
+    Weight max_edge_weight,
+    Neighbors&& neighbors,
+    Predecessors mode = Predecessors::ONE)
+{
+    return dijkstra(num_nodes, std::vector<Node>{source}, max_edge_weight, std::forward<Neighbors>(neighbors), mode);
+}
+
+/**
+ * @brief Returns a `neighbors` callable for unit-weight moves between
+ *        horizontally or vertically adjacent cells of `board`.
+ *
+ * Nodes are board.index_of() cell indices.  The board must have a border
+ * of at least one impassable cell (see BasicBoard::with_border()), so that
+ * no move ever leaves the buffer.
+ */
+template <typename T, typename Passable>
+auto cardinal_moves(const BasicBoard<T>& board, Passable passable)
+{
+    assert(board.padding() >= 1);
+
+    auto stride = static_cast<Node>(board.stride());
+    return [&board, passable, stride](Node u, auto&& emit) {
+        for (Node v : std::array<Node, 4>{u - stride, u + 1, u + stride, u - 1})
+        {
+            if (passable(board[v]))
+            {
+                emit(v, 1);
+            }
+        }
+    };
+}
+
+} // namespace search
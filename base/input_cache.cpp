@@ -0,0 +1,77 @@
+#include "input_cache.h"
+
+#include "base.h"
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+using namespace std;
+
+namespace input_cache
+{
+
+namespace
+{
+
+using Clock = chrono::steady_clock;
+using Key = tuple<string, bool, type_index>;
+
+struct Entry
+{
+    mutex mtx;
+    shared_ptr<const void> value;
+    chrono::nanoseconds parse_time{0};
+};
+
+mutex g_mutex;
+map<Key, shared_ptr<Entry>> g_entries;
+Stats g_stats{0, 0, chrono::nanoseconds{0}, chrono::nanoseconds{0}};
+
+} // namespace
+
+shared_ptr<const void> get_erased(const string& path, type_index type, const function<shared_ptr<const void>()>& parse)
+{
+    shared_ptr<Entry> entry;
+    {
+        lock_guard lock{g_mutex};
+        auto& slot = g_entries[{path, g_test_input, type}];
+        if (!slot)
+        {
+            slot = make_shared<Entry>();
+        }
+        entry = slot;
+    }
+
+    lock_guard entry_lock{entry->mtx};
+    if (entry->value)
+    {
+        lock_guard lock{g_mutex};
+        g_stats.hits++;
+        g_stats.saved_time += entry->parse_time;
+        return entry->value;
+    }
+
+    auto start = Clock::now();
+    entry->value = parse();
+    entry->parse_time = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start);
+
+    lock_guard lock{g_mutex};
+    g_stats.misses++;
+    g_stats.parse_time += entry->parse_time;
+    return entry->value;
+}
+
+Stats stats()
+{
+    lock_guard lock{g_mutex};
+    return g_stats;
+}
+
+void clear()
+{
+    lock_guard lock{g_mutex};
+    g_entries.clear();
+}
+
+} // namespace input_cache
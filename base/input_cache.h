@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+
+/**
+ * @brief A process-wide cache of parsed puzzle inputs.
+ *
+ * Both parts of a day usually start by reading and parsing the same file.
+ * Routing that parse through input_cache::get() means it happens once; the
+ * second part gets the same immutable structure.  Entries are keyed by the
+ * input path, the current value of g_test_input, and the parsed type, so
+ * example and real inputs never collide.
+ *
+ * Callers that need to mutate the parsed input must copy it.
+ */
+namespace input_cache
+{
+
+struct Stats
+{
+    std::size_t hits;
+    std::size_t misses;
+
+    // Total time spent parsing, and time that would have been spent
+    // re-parsing had every hit been a miss.
+    std::chrono::nanoseconds parse_time;
+    std::chrono::nanoseconds saved_time;
+};
+
+std::shared_ptr<const void> get_erased(
+    const std::string& path,
+    std::type_index type,
+    const std::function<std::shared_ptr<const void>()>& parse
+);
+
+/**
+ * @brief Returns the cached result of `parse()` for the given input,
+ *        invoking it if this is the first request.
+ *
+ * Concurrent requests for the same entry block until the first one has
+ * finished parsing.  If parsing throws, nothing is cached.
+ */
+template <typename F>
+std::shared_ptr<const std::invoke_result_t<F>> get(const std::string& path, F&& parse)
+{
+    using T = std::invoke_result_t<F>;
+
+    auto erased = get_erased(path, typeid(T), [&parse]() -> std::shared_ptr<const void> {
+        return std::make_shared<const T>(parse());
+    });
+    return std::static_pointer_cast<const T>(erased);
+}
+
+Stats stats();
+
+/**
+ * @brief Drops every cached entry.  Statistics are preserved.
+ */
+void clear();
+
+} // namespace input_cache
@@ -0,0 +1,208 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const string& path)
+    : data_{nullptr}
+    , size_{0}
+    , owned_{false}
+    , file_handle_{INVALID_HANDLE_VALUE}
+    , mapping_handle_{nullptr}
+{
+    file_handle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE)
+    {
+        throw runtime_error("cannot open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_handle_, &size))
+    {
+        release();
+        throw runtime_error("cannot stat " + path);
+    }
+
+    owned_ = true;
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0)
+    {
+        // Empty files can't be mapped, but there's nothing to read anyways.
+        data_ = "";
+        return;
+    }
+
+    mapping_handle_ = CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle_ == nullptr)
+    {
+        release();
+        throw runtime_error("cannot map " + path);
+    }
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr)
+    {
+        release();
+        throw runtime_error("cannot map " + path);
+    }
+}
+
+MappedFile::MappedFile(const char* data, size_t size)
+    : data_{data}
+    , size_{size}
+    , owned_{false}
+    , file_handle_{INVALID_HANDLE_VALUE}
+    , mapping_handle_{nullptr}
+{}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_{exchange(other.data_, nullptr)}
+    , size_{exchange(other.size_, 0)}
+    , owned_{exchange(other.owned_, false)}
+    , file_handle_{exchange(other.file_handle_, INVALID_HANDLE_VALUE)}
+    , mapping_handle_{exchange(other.mapping_handle_, nullptr)}
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        data_ = exchange(other.data_, nullptr);
+        size_ = exchange(other.size_, 0);
+        owned_ = exchange(other.owned_, false);
+        file_handle_ = exchange(other.file_handle_, INVALID_HANDLE_VALUE);
+        mapping_handle_ = exchange(other.mapping_handle_, nullptr);
+    }
+    return *this;
+}
+
+void MappedFile::release() noexcept
+{
+    if (owned_ && size_ > 0 && data_ != nullptr)
+    {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_ != nullptr)
+    {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_ != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file_handle_);
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+    owned_ = false;
+    file_handle_ = INVALID_HANDLE_VALUE;
+    mapping_handle_ = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const string& path)
+    : data_{nullptr}
+    , size_{0}
+    , owned_{false}
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("cannot open " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw runtime_error("cannot stat " + path);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0)
+    {
+        // Empty files can't be mapped, but there's nothing to read anyways.
+        ::close(fd);
+        data_ = "";
+        return;
+    }
+
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+
+    if (p == MAP_FAILED)
+    {
+        throw runtime_error("cannot map " + path);
+    }
+
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(p);
+    owned_ = true;
+}
+
+MappedFile::MappedFile(const char* data, size_t size)
+    : data_{data}
+    , size_{size}
+    , owned_{false}
+{}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_{exchange(other.data_, nullptr)}
+    , size_{exchange(other.size_, 0)}
+    , owned_{exchange(other.owned_, false)}
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        data_ = exchange(other.data_, nullptr);
+        size_ = exchange(other.size_, 0);
+        owned_ = exchange(other.owned_, false);
+    }
+    return *this;
+}
+
+void MappedFile::release() noexcept
+{
+    if (owned_)
+    {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+    owned_ = false;
+}
+
+#endif
+
+MappedFile MappedFile::wrap(string_view text)
+{
+    return MappedFile{text.data(), text.size()};
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief A read-only view of an entire input file, memory-mapped so that
+ *        parsers can work directly on the file's bytes without copying.
+ *
+ * A MappedFile can also wrap text that already lives in memory (e.g. a
+ * day's embedded test input), so that callers can treat both sources the
+ * same way.  In that case the text must outlive the MappedFile.
+ *
+ * Move-only; the mapping is released on destruction.
+ */
+class MappedFile
+{
+    const char* data_;
+    std::size_t size_;
+    bool owned_;
+
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#endif
+
+public:
+    /**
+     * @brief Maps the file at `path`.
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path);
+
+    /**
+     * @brief Wraps existing text without copying or taking ownership.
+     */
+    static MappedFile wrap(std::string_view text);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    std::string_view contents() const
+    {
+        return {data_, size_};
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    MappedFile(const char* data, std::size_t size);
+
+    void release() noexcept;
+};
@@ -1,12 +1,14 @@
 #pragma once
 
 #include "board.h"
+#include "mapped_file.h"
 
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -65,6 +67,75 @@ std::vector<std::invoke_result_t<F, std::string>> Lines(const std::string& s, F&
     return Lines(ss, fn);
 }
 
+/**
+ * @brief Calls fn with a view of each line of text, without copying.
+ *
+ * Lines may end in either "\n" or "\r\n"; the terminator is not part of
+ * the view.  As with Lines(std::istream&), leading whitespace is skipped
+ * and a final newline does not produce an empty trailing line.
+ */
+template <typename F>
+void ForEachLine(std::string_view text, F&& fn)
+{
+    size_t pos = text.find_first_not_of(" \t\r\n\v\f");
+    if (pos == std::string_view::npos)
+    {
+        return;
+    }
+    text.remove_prefix(pos);
+
+    while (!text.empty())
+    {
+        size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+
+        fn(line);
+
+        if (eol == std::string_view::npos)
+        {
+            break;
+        }
+        text.remove_prefix(eol + 1);
+    }
+}
+
+inline std::vector<std::string_view> Lines(const MappedFile& file)
+{
+    std::vector<std::string_view> lines;
+    ForEachLine(file.contents(), [&lines](std::string_view line) { lines.push_back(line); });
+    return lines;
+}
+
+// Callbacks that accept a string_view see the mapped bytes directly;
+// those that want a std::string get a copy of each line.
+template <typename F>
+using LineResult = std::conditional_t<
+    std::is_invocable_v<F, std::string_view>,
+    std::invoke_result<F, std::string_view>,
+    std::invoke_result<F, std::string>
+>::type;
+
+template <typename F>
+std::vector<LineResult<F>> Lines(const MappedFile& file, F&& fn)
+{
+    std::vector<LineResult<F>> lines;
+    ForEachLine(file.contents(), [&](std::string_view line) {
+        if constexpr (std::is_invocable_v<F, std::string_view>)
+        {
+            lines.push_back(fn(line));
+        }
+        else
+        {
+            lines.push_back(fn(std::string{line}));
+        }
+    });
+    return lines;
+}
+
 inline std::string String(std::istream& in)
 {
     // eat leading whitespace
@@ -116,4 +187,13 @@ inline ::Board Board(const std::unique_ptr<std::istream>& in)
     return Board(*in);
 }
 
+inline ::Board Board(const MappedFile& file)
+{
+    std::vector<std::vector<char>> contents;
+    ForEachLine(file.contents(), [&contents](std::string_view line) {
+        contents.emplace_back(line.begin(), line.end());
+    });
+    return {std::move(contents)};
+}
+
 } // namespace parsers
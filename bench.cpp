@@ -0,0 +1,293 @@
+#include "bench.h"
+
+#include "input_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#include <fmt/format.h>
+
+using namespace std;
+
+namespace
+{
+
+atomic<uintmax_t> g_allocated_bytes{0};
+
+} // namespace
+
+// Replacing the global allocation functions lets us report how much memory
+// each solution asks for.  The standard library routes the array and
+// nothrow forms through these two, but the aligned forms need their own
+// replacements since they go straight to the aligned allocator.
+namespace
+{
+
+template <typename Alloc>
+void* allocate(size_t size, Alloc&& alloc)
+{
+    g_allocated_bytes.fetch_add(size, memory_order_relaxed);
+
+    while (true)
+    {
+        if (void* p = alloc(size == 0 ? 1 : size))
+        {
+            return p;
+        }
+
+        // As a replacement operator new must, give the installed handler a
+        // chance to free some memory before giving up.
+        new_handler handler = get_new_handler();
+        if (handler == nullptr)
+        {
+            throw bad_alloc{};
+        }
+        handler();
+    }
+}
+
+void* aligned_malloc(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment.
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void aligned_free(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    return allocate(size, [](size_t n) { return malloc(n); });
+}
+
+void* operator new(size_t size, align_val_t alignment)
+{
+    return allocate(size, [alignment](size_t n) { return aligned_malloc(n, static_cast<size_t>(alignment)); });
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, align_val_t) noexcept
+{
+    aligned_free(p);
+}
+
+void operator delete(void* p, size_t, align_val_t) noexcept
+{
+    aligned_free(p);
+}
+
+namespace bench
+{
+
+namespace
+{
+
+using Clock = chrono::steady_clock;
+
+chrono::nanoseconds percentile(const vector<chrono::nanoseconds>& sorted, double pct)
+{
+    // nearest-rank percentile
+    auto rank = static_cast<size_t>(ceil(pct / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[clamp(rank, 1_z, sorted.size()) - 1];
+}
+
+chrono::nanoseconds median(const vector<chrono::nanoseconds>& sorted)
+{
+    size_t mid = sorted.size() / 2;
+    if (sorted.size() % 2 == 1)
+    {
+        return sorted[mid];
+    }
+    return (sorted[mid - 1] + sorted[mid]) / 2;
+}
+
+string human(chrono::nanoseconds ns)
+{
+    auto n = static_cast<double>(ns.count());
+    if (n < 1e3) return fmt::format("{:.0f} ns", n);
+    if (n < 1e6) return fmt::format("{:.2f} us", n / 1e3);
+    if (n < 1e9) return fmt::format("{:.2f} ms", n / 1e6);
+    return fmt::format("{:.3f} s", n / 1e9);
+}
+
+string json_escape(const string& s)
+{
+    string result;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            // Control characters (newlines included) may not appear raw in
+            // a JSON string.
+            result += fmt::format("\\u{:04x}", static_cast<unsigned char>(c));
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result;
+}
+
+// Quotes a CSV field per RFC 4180 if it contains a comma, a quote or a
+// line break, doubling any embedded quotes.
+string csv_field(const string& s)
+{
+    if (s.find_first_of(",\"\r\n") == string::npos)
+    {
+        return s;
+    }
+
+    string result = "\"";
+    for (char c : s)
+    {
+        if (c == '"')
+        {
+            result += '"';
+        }
+        result += c;
+    }
+    result += '"';
+    return result;
+}
+
+} // namespace
+
+optional<Format> parse_format(const string& name)
+{
+    if (name == "text") return Format::TEXT;
+    if (name == "json") return Format::JSON;
+    if (name == "csv")  return Format::CSV;
+    return nullopt;
+}
+
+Stats measure(pair<int, int> key, Problem& problem, size_t warmup, size_t iterations)
+{
+    // Each run should pay for its own parsing, so drop anything that the
+    // input cache is holding on to before every call.
+    string answer;
+    for (size_t i = 0; i < warmup; ++i)
+    {
+        input_cache::clear();
+        answer = problem.solve();
+    }
+
+    vector<chrono::nanoseconds> times;
+    times.reserve(iterations);
+
+    auto bytes_before = g_allocated_bytes.load(memory_order_relaxed);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        input_cache::clear();
+
+        auto start = Clock::now();
+        answer = problem.solve();
+        auto stop = Clock::now();
+        times.push_back(chrono::duration_cast<chrono::nanoseconds>(stop - start));
+    }
+    auto bytes_after = g_allocated_bytes.load(memory_order_relaxed);
+
+    sort(times.begin(), times.end());
+
+    return {
+        .key = key,
+        .iterations = iterations,
+        .min = times.front(),
+        .median = median(times),
+        .p99 = percentile(times, 99.0),
+        .allocated_bytes = (bytes_after - bytes_before) / iterations,
+        .answer = std::move(answer),
+    };
+}
+
+void print(Format format, const vector<Stats>& results)
+{
+    switch (format)
+    {
+    case Format::TEXT:
+        for (const auto& s : results)
+        {
+            fmt::println(
+                "Day {:>2} Part {}: min {:>10}  median {:>10}  p99 {:>10}  alloc {:>12} B  ({} runs)",
+                s.key.first,
+                s.key.second,
+                human(s.min),
+                human(s.median),
+                human(s.p99),
+                s.allocated_bytes,
+                s.iterations
+            );
+        }
+        break;
+
+    case Format::JSON:
+        fmt::println("[");
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& s = results[i];
+            fmt::println(
+                R"(  {{"day": {}, "part": {}, "iterations": {}, "min_ns": {}, "median_ns": {}, "p99_ns": {}, "alloc_bytes": {}, "answer": "{}"}}{})",
+                s.key.first,
+                s.key.second,
+                s.iterations,
+                s.min.count(),
+                s.median.count(),
+                s.p99.count(),
+                s.allocated_bytes,
+                json_escape(s.answer),
+                i + 1 < results.size() ? "," : ""
+            );
+        }
+        fmt::println("]");
+        break;
+
+    case Format::CSV:
+        fmt::println("day,part,iterations,min_ns,median_ns,p99_ns,alloc_bytes,answer");
+        for (const auto& s : results)
+        {
+            fmt::println(
+                "{},{},{},{},{},{},{},{}",
+                s.key.first,
+                s.key.second,
+                s.iterations,
+                s.min.count(),
+                s.median.count(),
+                s.p99.count(),
+                s.allocated_bytes,
+                csv_field(s.answer)
+            );
+        }
+        break;
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "base.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+enum class Format
+{
+    TEXT,
+    JSON,
+    CSV
+};
+
+std::optional<Format> parse_format(const std::string& name);
+
+/**
+ * @brief Timing statistics for one (day, part) over all measured iterations.
+ *
+ * allocated_bytes is the mean number of bytes requested from the global
+ * operator new per iteration; it is only tracked when the runner's
+ * counting allocator is linked in (see bench.cpp).
+ */
+struct Stats
+{
+    std::pair<int, int> key;
+    std::size_t iterations;
+    std::chrono::nanoseconds min;
+    std::chrono::nanoseconds median;
+    std::chrono::nanoseconds p99;
+    std::uintmax_t allocated_bytes;
+    std::string answer;
+};
+
+/**
+ * @brief Runs problem->solve() `warmup` times untimed, then `iterations`
+ *        times timed, and summarizes the results.
+ *
+ * Exceptions from solve() propagate to the caller.
+ */
+Stats measure(std::pair<int, int> key, Problem& problem, std::size_t warmup, std::size_t iterations);
+
+void print(Format format, const std::vector<Stats>& results);
+
+} // namespace bench
@@ -0,0 +1,169 @@
+// Neighbor-scan throughput of the flat BasicBoard versus the nested
+// vector-of-vectors layout that it replaced.
+//
+// Usage: board_bench [size] [iterations]
+
+#include "board.h"
+#include "point.h"
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+
+using Clock = chrono::steady_clock;
+
+// The pre-flattening layout: one heap allocation per row, two dependent
+// loads per cell access.
+class NestedBoard
+{
+    vector<vector<char>> contents_;
+    int num_rows_;
+    int num_cols_;
+
+public:
+    NestedBoard(const vector<vector<char>>& contents)
+        : contents_(contents)
+        , num_rows_(static_cast<int>(contents.size()))
+        , num_cols_(static_cast<int>(contents[0].size()))
+    {}
+
+    int num_rows() const { return num_rows_; }
+    int num_cols() const { return num_cols_; }
+
+    char at(Point p) const
+    {
+        return contents_[static_cast<size_t>(p.y())][static_cast<size_t>(p.x())];
+    }
+
+    bool in_bounds(Point p) const
+    {
+        return p.y() >= 0 && p.y() < num_rows_ && p.x() >= 0 && p.x() < num_cols_;
+    }
+};
+
+template <typename B>
+size_t count_walls_checked(const B& board)
+{
+    size_t count = 0;
+    for (int y = 0; y < board.num_rows(); ++y)
+    {
+        for (int x = 0; x < board.num_cols(); ++x)
+        {
+            Point p{x, y};
+            for (auto d : Dir::CARDINALS)
+            {
+                Point n = p + d;
+                if (board.in_bounds(n) && board.at(n) == '#')
+                {
+                    count++;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+size_t count_walls_padded(const Board& board)
+{
+    // Every in-bounds cell's neighbors are in the buffer, so no checks.
+    const auto stride = static_cast<size_t>(board.stride());
+    size_t count = 0;
+    for (int y = 0; y < board.num_rows(); ++y)
+    {
+        size_t ix = board.index_of({0, y});
+        for (int x = 0; x < board.num_cols(); ++x, ++ix)
+        {
+            count += (board[ix - stride] == '#')
+                   + (board[ix + 1] == '#')
+                   + (board[ix + stride] == '#')
+                   + (board[ix - 1] == '#');
+        }
+    }
+    return count;
+}
+
+// Each scan reads a board that never changes, so without these the
+// optimizer is free to run it once and reuse the answer for every
+// iteration.  clobber_memory() makes the compiler assume any memory may
+// have changed, and keep() that `value` is needed.
+void clobber_memory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    _ReadWriteBarrier();
+#endif
+}
+
+void keep(size_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile size_t sink;
+    sink = value;
+#endif
+}
+
+template <typename F>
+void run(const char* name, size_t cells, int iterations, F&& scan)
+{
+    size_t result = scan(); // warm up
+
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        clobber_memory();
+        result += scan();
+        keep(result);
+    }
+    chrono::duration<double> elapsed = Clock::now() - start;
+
+    double cells_per_sec = static_cast<double>(cells) * iterations / elapsed.count();
+    fmt::println("{:<24} {:>10.1f} Mcells/s  (checksum {})", name, cells_per_sec / 1e6, result);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int size = argc > 1 ? stoi(argv[1]) : 2000;
+    int iterations = argc > 2 ? stoi(argv[2]) : 20;
+
+    mt19937 rng{2024};
+    bernoulli_distribution is_wall{0.3};
+
+    vector<vector<char>> cells(static_cast<size_t>(size), vector<char>(static_cast<size_t>(size)));
+    for (auto& row : cells)
+    {
+        for (auto& c : row)
+        {
+            c = is_wall(rng) ? '#' : '.';
+        }
+    }
+
+    NestedBoard nested{cells};
+    Board flat{cells};
+    Board padded = flat.with_border(1, '.');
+
+    auto num_cells = static_cast<size_t>(size) * static_cast<size_t>(size);
+    fmt::println("{}x{} board, {} iterations", size, size, iterations);
+    run("nested, checked", num_cells, iterations, [&] { return count_walls_checked(nested); });
+    run("flat, checked", num_cells, iterations, [&] { return count_walls_checked(flat); });
+    run("flat padded, unchecked", num_cells, iterations, [&] { return count_walls_padded(padded); });
+
+    return 0;
+}
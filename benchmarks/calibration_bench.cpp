@@ -0,0 +1,173 @@
+// Day 7's backward, pruning calibration solver versus the forward
+// enumeration of every operator combination that it replaced, on batches
+// of equations with increasingly long operand lists.
+//
+// Usage: calibration_bench [equations per length] [max length]
+
+#include "day07/calibrate.h"
+#include "numbers.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+using namespace std;
+
+namespace
+{
+
+using Clock = chrono::steady_clock;
+
+struct Equation
+{
+    uintmax_t expected;
+    vector<uintmax_t> values;
+};
+
+// The old approach: count through every assignment of operators as a
+// base-num_ops number, evaluating each one from scratch.
+bool enumerate_ops(const Equation& eq, int num_ops)
+{
+    vector<int> ops(eq.values.size() - 1, 0);
+    while (true)
+    {
+        uintmax_t result = eq.values[0];
+        for (size_t i = 1; i < eq.values.size() && result <= eq.expected; ++i)
+        {
+            uintmax_t rhs = eq.values[i];
+            switch (ops[i - 1])
+            {
+            case 0: result += rhs; break;
+            case 1: result *= rhs; break;
+            default: result = Numbers::shl10(result, Numbers::count_digits(rhs)) + rhs; break;
+            }
+        }
+
+        if (result == eq.expected)
+        {
+            return true;
+        }
+
+        size_t i = 0;
+        for (; i < ops.size(); ++i)
+        {
+            if (++ops[i] < num_ops)
+            {
+                break;
+            }
+            ops[i] = 0;
+        }
+
+        if (i == ops.size())
+        {
+            return false;
+        }
+    }
+}
+
+// Half of the equations are solvable, built from random operators; the
+// rest have a random target near the solvable one.  Operators are mostly
+// + and * so that targets stay well inside 64 bits.
+vector<Equation> make_batch(mt19937_64& rng, size_t count, size_t length)
+{
+    uniform_int_distribution<uintmax_t> operand{1, 9};
+    uniform_int_distribution<int> op{0, 9};
+
+    vector<Equation> batch;
+    for (size_t n = 0; n < count; ++n)
+    {
+        Equation eq;
+        eq.expected = operand(rng);
+        eq.values.push_back(eq.expected);
+        for (size_t i = 1; i < length; ++i)
+        {
+            uintmax_t rhs = operand(rng);
+            int o = op(rng);
+            if (o == 0 && eq.expected < 1'000'000'000)
+            {
+                eq.expected = Numbers::shl10(eq.expected, Numbers::count_digits(rhs)) + rhs;
+            }
+            else if (o <= 3 && eq.expected < 1'000'000'000)
+            {
+                eq.expected *= rhs;
+            }
+            else
+            {
+                eq.expected += rhs;
+            }
+            eq.values.push_back(rhs);
+        }
+
+        if (n % 2 == 1)
+        {
+            eq.expected += 1 + rng() % 7;
+        }
+        batch.push_back(std::move(eq));
+    }
+    return batch;
+}
+
+template <typename F>
+double run(const vector<Equation>& batch, size_t& solved, F&& solve)
+{
+    auto start = Clock::now();
+    solved = 0;
+    for (const auto& eq : batch)
+    {
+        solved += solve(eq) ? 1 : 0;
+    }
+    chrono::duration<double, micro> elapsed = Clock::now() - start;
+    return elapsed.count() / static_cast<double>(batch.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? stoul(argv[1]) : 200;
+    size_t max_length = argc > 2 ? stoul(argv[2]) : 40;
+
+    // Enumeration is 3^(n-1) per unsolvable equation; past this it would
+    // take hours.
+    constexpr size_t kMaxEnumerated = 13;
+
+    mt19937_64 rng{2024};
+
+    fmt::println("{} equations per length, three operators", count);
+    fmt::println("{:>6}  {:>18}  {:>18}", "length", "enumerate us/eq", "backward us/eq");
+    for (size_t length = 4; length <= max_length; length += length < 16 ? 1 : 8)
+    {
+        auto batch = make_batch(rng, count, length);
+
+        size_t solved_backward = 0;
+        double backward = run(batch, solved_backward, [](const Equation& eq) {
+            return day07::can_calibrate(eq.expected, eq.values, true);
+        });
+
+        if (length <= kMaxEnumerated)
+        {
+            size_t solved_enumerated = 0;
+            double enumerated = run(batch, solved_enumerated, [](const Equation& eq) {
+                return enumerate_ops(eq, 3);
+            });
+
+            if (solved_enumerated != solved_backward)
+            {
+                fmt::println("mismatch at length {}: {} vs {}", length, solved_enumerated, solved_backward);
+                return 1;
+            }
+            fmt::println("{:>6}  {:>18.2f}  {:>18.2f}", length, enumerated, backward);
+        }
+        else
+        {
+            fmt::println("{:>6}  {:>18}  {:>18.2f}", length, "-", backward);
+        }
+    }
+
+    return 0;
+}
@@ -1,14 +1,23 @@
 #include "day01.h"
 
+#include "input_cache.h"
+#include "mapped_file.h"
+#include "parsers.h"
+
 #include <algorithm>
-#include <fstream>
-#include <iostream>
-#include <map>
+#include <array>
+#include <cstdint>
+#include <execution>
+#include <limits>
 #include <memory>
 #include <numeric>
-#include <ranges>
-#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
+#include <version>
 
 namespace day01
 {
@@ -26,57 +35,248 @@ constexpr const char* kTestInput = R"(3   4
 3   9
 3   3)";
 
-unique_ptr<istream> get_input()
+// Below this many values, the sort isn't worth splitting across threads.
+constexpr size_t kParallelThreshold = 1 << 16;
+
+struct Columns
+{
+    // Both sorted ascending.
+    vector<uint32_t> left;
+    vector<uint32_t> right;
+};
+
+MappedFile open_input()
 {
     if (g_test_input)
     {
-        return make_unique<stringstream>(kTestInput);
+        return MappedFile::wrap(kTestInput);
     }
 
-    return make_unique<ifstream>(kInputFile);
+    return MappedFile{kInputFile};
 }
 
-} // namespace
+/**
+ * @brief Reads one pair of non-negative integers per line straight out of
+ *        `text`.  Blank lines are skipped; any other line must hold
+ *        exactly two values separated by whitespace.
+ */
+Columns parse_columns(string_view text)
+{
+    Columns columns;
 
-string PartOne::solve()
+    size_t num_lines = static_cast<size_t>(count(text.begin(), text.end(), '\n')) + 1;
+    columns.left.reserve(num_lines);
+    columns.right.reserve(num_lines);
+
+    auto is_space = [](char c) { return c == ' ' || c == '\t'; };
+    auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+
+    parsers::ForEachLine(text, [&](string_view line) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+
+        array<uint32_t, 2> values;
+        size_t num_values = 0;
+        while (true)
+        {
+            while (p != end && is_space(*p))
+            {
+                ++p;
+            }
+            if (p == end)
+            {
+                break;
+            }
+            if (!is_digit(*p) || num_values == values.size())
+            {
+                throw runtime_error("Invalid input");
+            }
+
+            uint64_t value = 0;
+            for (; p != end && is_digit(*p); ++p)
+            {
+                value = value * 10 + static_cast<uint64_t>(*p - '0');
+                if (value > numeric_limits<uint32_t>::max())
+                {
+                    throw out_of_range("Value too large");
+                }
+            }
+            values[num_values++] = static_cast<uint32_t>(value);
+        }
+
+        if (num_values == 0)
+        {
+            return;
+        }
+        if (num_values != values.size())
+        {
+            throw runtime_error("Invalid input - expected two values per line");
+        }
+
+        columns.left.push_back(values[0]);
+        columns.right.push_back(values[1]);
+    });
+
+    return columns;
+}
+
+/**
+ * @brief Sorts `xs` one byte at a time, least significant first.
+ *
+ * Large inputs are cut into one chunk per core.  Each pass counts every
+ * chunk's digits in parallel, turns the counts into per-chunk output
+ * offsets, and then scatters the chunks in parallel; since each chunk
+ * owns its own range of every bucket, no writes collide and the sort
+ * stays stable.  Passes over a byte that's the same in every value (e.g.
+ * the high bytes of small IDs) are skipped.
+ */
+void radix_sort(vector<uint32_t>& xs)
 {
-    vector<int> left, right;
-    auto input = get_input();
+    constexpr unsigned kRadixBits = 8;
+    constexpr size_t kNumBuckets = size_t{1} << kRadixBits;
+    using Counts = array<size_t, kNumBuckets>;
+
+    const size_t n = xs.size();
+    const size_t num_chunks = n < kParallelThreshold ? 1 : max<size_t>(1, thread::hardware_concurrency());
+
+    vector<size_t> chunks(num_chunks);
+    iota(chunks.begin(), chunks.end(), 0);
+    auto chunk_range = [n, num_chunks](size_t c) { return pair{n * c / num_chunks, n * (c + 1) / num_chunks}; };
 
-    int x, y;
-    while (*input >> x >> y)
+    vector<Counts> offsets(num_chunks);
+    vector<uint32_t> scratch(n);
+
+    for (unsigned shift = 0; shift < 32; shift += kRadixBits)
     {
-        left.push_back(x);
-        right.push_back(y);
-    }
+        auto digit = [shift](uint32_t x) { return (x >> shift) & (kNumBuckets - 1); };
+
+        for_each(
+#if __cpp_lib_parallel_algorithm
+            execution::par,
+#endif
+            chunks.begin(), chunks.end(),
+            [&](size_t c) {
+                auto& counts = offsets[c];
+                counts.fill(0);
+                auto [begin, end] = chunk_range(c);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    counts[digit(xs[i])]++;
+                }
+            }
+        );
 
-    sort(left.begin(), left.end());
-    sort(right.begin(), right.end());
+        size_t running = 0;
+        bool all_same = false;
+        for (size_t b = 0; b < kNumBuckets; ++b)
+        {
+            size_t bucket_start = running;
+            for (auto& counts : offsets)
+            {
+                size_t count = counts[b];
+                counts[b] = running;
+                running += count;
+            }
+            all_same |= running - bucket_start == n;
+        }
+        if (all_same)
+        {
+            continue;
+        }
 
-    auto diff = [](tuple<int, int> xy) { return abs(get<0>(xy) - get<1>(xy)); };
+        for_each(
+#if __cpp_lib_parallel_algorithm
+            execution::par,
+#endif
+            chunks.begin(), chunks.end(),
+            [&](size_t c) {
+                auto& next = offsets[c];
+                auto [begin, end] = chunk_range(c);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    scratch[next[digit(xs[i])]++] = xs[i];
+                }
+            }
+        );
 
-    // we _were_ using zip_transform, but AppleClang sux and doesn't have it
-    auto xs = views::zip(left, right) | views::transform(diff);
-    return to_string(accumulate(xs.begin(), xs.end(), 0L));
+        swap(xs, scratch);
+    }
 }
 
-string PartTwo::solve()
+shared_ptr<const Columns> read_columns()
+{
+    return input_cache::get(kInputFile, [] {
+        auto input = open_input();
+        Columns columns = parse_columns(input.contents());
+        radix_sort(columns.left);
+        radix_sort(columns.right);
+        return columns;
+    });
+}
+
+} // namespace
+
+string PartOne::solve()
 {
-    vector<int> left;
-    map<int, int> right_column_counts;
-    auto input = get_input();
+    auto columns = read_columns();
+    const auto& left = columns->left;
+    const auto& right = columns->right;
 
-    int x, y;
-    while (*input >> x >> y)
+    uint64_t total = 0;
+    for (size_t i = 0; i < left.size(); ++i)
     {
-        left.push_back(x);
-        right_column_counts[y]++;
+        total += left[i] > right[i] ? left[i] - right[i] : right[i] - left[i];
     }
+    return to_string(total);
+}
 
-    long score = 0;
-    for (int n : left)
+string PartTwo::solve()
+{
+    auto columns = read_columns();
+    const auto& left = columns->left;
+    const auto& right = columns->right;
+
+    // Both columns are sorted, so walking them together pairs each run of
+    // equal values on the left with the matching run (if any) on the right.
+    uint64_t score = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < left.size() && j < right.size())
     {
-        score += (n * right_column_counts[n]);
+        uint32_t value = left[i];
+        if (right[j] < value)
+        {
+            ++j;
+            continue;
+        }
+
+        size_t left_run = i;
+        while (i < left.size() && left[i] == value)
+        {
+            ++i;
+        }
+
+        size_t right_run = j;
+        while (j < right.size() && right[j] == value)
+        {
+            ++j;
+        }
+
+        // value * left count * right count, checked at each step
+        uint64_t term = value;
+        for (uint64_t count : {uint64_t{i - left_run}, uint64_t{j - right_run}})
+        {
+            if (count != 0 && term > numeric_limits<uint64_t>::max() / count)
+            {
+                throw overflow_error{"Overflow"};
+            }
+            term *= count;
+        }
+        if (score + term < score)
+        {
+            throw overflow_error{"Overflow"};
+        }
+        score += term;
     }
 
     return to_string(score);
@@ -1,16 +1,20 @@
 #include "day02.h"
 
+#include "input_cache.h"
 #include "parsers.h"
 
 #include <algorithm>
-#include <fstream>
+#include <charconv>
+#include <cstddef>
+#include <execution>
 #include <iostream>
-#include <map>
 #include <memory>
-#include <ranges>
-#include <sstream>
+#include <span>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <vector>
+#include <version>
 
 namespace day02
 {
@@ -18,7 +22,7 @@ namespace day02
 using namespace std;
 using namespace std::string_view_literals;
 
-using Report = vector<int>;
+using Report = span<const int>;
 
 namespace
 {
@@ -31,80 +35,158 @@ constexpr const char* kTestInput = R"(7 6 4 2 1
 8 6 4 4 1
 1 3 6 7 9)";
 
-unique_ptr<istream> get_input()
+MappedFile open_input()
 {
     if (g_test_input)
     {
-        return make_unique<stringstream>(kTestInput);
+        return MappedFile::wrap(kTestInput);
     }
 
-    return make_unique<ifstream>(kInputFile);
+    return MappedFile{kInputFile};
 }
 
-Report from_string(const string& s)
+/**
+ * @brief Every report's levels, packed end to end in one flat arena.
+ */
+class Reports
 {
-    Report report;
-    stringstream ss(s);
-    int x;
-    while (ss >> x)
+    struct Extent
     {
-        report.push_back(x);
-    }
-    return report;
-}
+        size_t start;
+        size_t length;
+    };
 
-vector<Report> read_reports()
-{
-    vector<Report> reports;
+    vector<int> levels_;
+    vector<Extent> extents_;
 
-    auto input = get_input();
-    return parsers::Lines(*input, from_string);
-}
-
-bool is_increasing(const Report& xs)
-{
-    return is_sorted(xs.begin(), xs.end());
-};
+public:
+    void add(string_view line)
+    {
+        size_t start = levels_.size();
+
+        const char* p = line.data();
+        const char* end = p + line.size();
+        while (true)
+        {
+            while (p != end && *p == ' ')
+            {
+                ++p;
+            }
+
+            int x;
+            auto [next, ec] = from_chars(p, end, x);
+            if (ec != errc{})
+            {
+                break;
+            }
+
+            levels_.push_back(x);
+            p = next;
+        }
+
+        extents_.push_back({start, levels_.size() - start});
+    }
 
-bool is_decreasing(const Report& xs)
-{
-    return is_sorted(xs.rbegin(), xs.rend());
+    /**
+     * @brief Counts the reports that satisfy `pred`, checking them in
+     *        parallel where supported.
+     */
+    template <typename Pred>
+    size_t count_if(Pred&& pred) const
+    {
+        return static_cast<size_t>(std::count_if(
+#if __cpp_lib_parallel_algorithm
+            execution::par,
+#endif
+            extents_.begin(), extents_.end(),
+            [this, &pred](const Extent& extent) {
+                return pred(Report{levels_}.subspan(extent.start, extent.length));
+            }
+        ));
+    }
 };
 
-bool is_ordered(const Report& xs)
+shared_ptr<const Reports> read_reports()
 {
-    return is_increasing(xs) || is_decreasing(xs);
-};
+    return input_cache::get(kInputFile, [] {
+        auto input = open_input();
+        Reports reports;
+        parsers::ForEachLine(input.contents(), [&reports](string_view line) { reports.add(line); });
+        return reports;
+    });
+}
 
-bool is_gradual(const Report& xs)
+constexpr size_t kNoSkip = static_cast<size_t>(-1);
+
+/**
+ * @brief Returns the position of the first level that breaks the report's
+ *        trend, or xs.size() if there is none.
+ *
+ * The level at `skip`, if any, is treated as though it weren't there.  The
+ * trend is set by the first difference: every difference must have the
+ * same sign, and be between 1 and 3 in size.
+ */
+size_t first_violation(Report xs, size_t skip = kNoSkip)
 {
-    for (size_t i = 1; i < xs.size(); ++i)
+    size_t prev = kNoSkip;
+    int direction = 0;
+    for (size_t i = 0; i < xs.size(); ++i)
     {
-        auto delta = abs(xs[i] - xs[i - 1]);
-        if (delta < 1 || delta > 3) return false;
+        if (i == skip)
+        {
+            continue;
+        }
+
+        if (prev != kNoSkip)
+        {
+            int delta = xs[i] - xs[prev];
+            if (direction == 0)
+            {
+                direction = delta < 0 ? -1 : 1;
+            }
+
+            int step = delta * direction;
+            if (step < 1 || step > 3)
+            {
+                return i;
+            }
+        }
+        prev = i;
     }
+    return xs.size();
+}
 
-    return true;
-};
-
-bool is_safe(const Report& xs)
+bool is_safe(Report xs)
 {
-    return is_ordered(xs) && is_gradual(xs);
-};
+    return first_violation(xs) == xs.size();
+}
 
-bool is_safe_with_dampener(const Report& xs)
+/**
+ * @brief Whether the report is safe after removing at most one level.
+ *
+ * Removing a level that comes well before the first violation can't fix
+ * it: every difference up to that point already agrees with the trend,
+ * so the trend stays the same.  That leaves the two levels on either side
+ * of the bad difference, plus the one before them, whose removal is the
+ * only way to change the trend when the violation is in the third level.
+ */
+bool is_safe_with_dampener(Report xs)
 {
-    if (is_safe(xs)) return true;
-
-    for (size_t i = 0; i < xs.size(); i++)
+    size_t i = first_violation(xs);
+    if (i == xs.size())
     {
-        Report modified_xs = xs;
-        modified_xs.erase(modified_xs.begin() + static_cast<long>(i));
-        if (is_safe(modified_xs)) return true;
+        return true;
     }
 
+    for (size_t skip : {i, i - 1, i - 2})
+    {
+        if (skip < xs.size() && first_violation(xs, skip) == xs.size())
+        {
+            return true;
+        }
+    }
     return false;
-};
+}
 
 } // namespace
 
@@ -112,18 +194,14 @@ string PartOne::solve()
 {
     auto reports = read_reports();
 
-    auto safe_reports = reports | views::filter(is_safe);
-
-    return to_string(ranges::distance(safe_reports));
+    return to_string(reports->count_if(is_safe));
 }
 
 std::string PartTwo::solve()
 {
     auto reports = read_reports();
 
-    auto safe_reports = reports | views::filter(is_safe_with_dampener);
-
-    return to_string(ranges::distance(safe_reports));
+    return to_string(reports->count_if(is_safe_with_dampener));
 }
 
 } // namespace day02
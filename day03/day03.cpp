@@ -1,14 +1,17 @@
 #include "day03.h"
 
-#include "parsers.h"
+#include "input_cache.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
-#include <regex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 using namespace std;
 
@@ -21,8 +24,182 @@ namespace
 constexpr const char* kInputFile = "day03/day03.input";
 constexpr const char* kTestInput = "xmul(2,4)&mul[3,7]!^don't()_mul(5,5)+mul(32,64](mul(11,8)undo()?mul(8,5))";
 
-const regex kMulExpr{R"(mul\((\d{1,3}),(\d{1,3})\))"};
-const regex kMulExprWithConditionals{R"(do\(\)|mul\((\d{1,3}),(\d{1,3})\)|don't\(\))"};
+constexpr size_t kChunkSize = 1 << 20;
+
+struct Totals
+{
+    // Sum of every mul(), and of only those not switched off by don't().
+    uint64_t all;
+    uint64_t enabled;
+};
+
+/**
+ * @brief Picks mul(X,Y), do() and don't() out of corrupted memory, one
+ *        chunk at a time.
+ *
+ * Matching is a small state machine whose state carries over from one
+ * chunk to the next, so an instruction split across a chunk boundary is
+ * still found.  Between instructions the scanner jumps straight to the
+ * next 'm' or 'd' with memchr.  Operands are accumulated as their digits
+ * go by.
+ *
+ * None of the three instructions can begin part way through a failed
+ * attempt at another, so when a character breaks a match, it only has to
+ * be looked at again as a possible start.
+ */
+class Scanner
+{
+    enum class State
+    {
+        kIdle,
+        kM, kMu, kMul, kLhs, kRhs,
+        kD, kDo, kDoOpen, kDon, kDonQuote, kDont, kDontOpen,
+    };
+
+    State state_ = State::kIdle;
+    uint32_t lhs_ = 0;
+    uint32_t rhs_ = 0;
+    int num_digits_ = 0;
+    bool enabled_ = true;
+    Totals totals_{0, 0};
+
+public:
+    void feed(string_view chunk)
+    {
+        const char* p = chunk.data();
+        const char* end = p + chunk.size();
+
+        auto find = [end](const char* from, char c) {
+            auto found = static_cast<const char*>(memchr(from, c, static_cast<size_t>(end - from)));
+            return found != nullptr ? found : end;
+        };
+
+        // The next 'm' and 'd' at or after p, or end if there are none.
+        const char* next_m = find(p, 'm');
+        const char* next_d = find(p, 'd');
+
+        while (p != end)
+        {
+            if (state_ == State::kIdle)
+            {
+                if (next_m < p) next_m = find(p, 'm');
+                if (next_d < p) next_d = find(p, 'd');
+                p = min(next_m, next_d);
+                if (p == end)
+                {
+                    break;
+                }
+            }
+
+            if (step(*p))
+            {
+                ++p;
+            }
+        }
+    }
+
+    Totals totals() const
+    {
+        return totals_;
+    }
+
+private:
+    // Advances the state machine by one character, returning false if `c`
+    // broke a match and should be looked at again from the idle state.
+    bool step(char c)
+    {
+        auto expect = [&](char expected, State next) {
+            if (c != expected)
+            {
+                state_ = State::kIdle;
+                return false;
+            }
+            state_ = next;
+            return true;
+        };
+
+        auto digit = [&](uint32_t& operand) {
+            if (c < '0' || c > '9' || num_digits_ == 3)
+            {
+                return false;
+            }
+            operand = operand * 10 + static_cast<uint32_t>(c - '0');
+            num_digits_++;
+            return true;
+        };
+
+        switch (state_)
+        {
+        case State::kIdle:
+            state_ = c == 'm' ? State::kM : State::kD;
+            return true;
+
+        case State::kM: return expect('u', State::kMu);
+        case State::kMu: return expect('l', State::kMul);
+        case State::kMul:
+            lhs_ = 0;
+            num_digits_ = 0;
+            return expect('(', State::kLhs);
+        case State::kLhs:
+            if (digit(lhs_))
+            {
+                return true;
+            }
+            if (num_digits_ == 0)
+            {
+                state_ = State::kIdle;
+                return false;
+            }
+            rhs_ = 0;
+            num_digits_ = 0;
+            return expect(',', State::kRhs);
+        case State::kRhs:
+            if (digit(rhs_))
+            {
+                return true;
+            }
+            if (num_digits_ == 0 || !expect(')', State::kIdle))
+            {
+                state_ = State::kIdle;
+                return false;
+            }
+            totals_.all += uint64_t{lhs_} * rhs_;
+            if (enabled_)
+            {
+                totals_.enabled += uint64_t{lhs_} * rhs_;
+            }
+            return true;
+
+        case State::kD: return expect('o', State::kDo);
+        case State::kDo:
+            if (c == 'n')
+            {
+                state_ = State::kDon;
+                return true;
+            }
+            return expect('(', State::kDoOpen);
+        case State::kDoOpen:
+            if (!expect(')', State::kIdle))
+            {
+                return false;
+            }
+            enabled_ = true;
+            return true;
+        case State::kDon: return expect('\'', State::kDonQuote);
+        case State::kDonQuote: return expect('t', State::kDont);
+        case State::kDont: return expect('(', State::kDontOpen);
+        case State::kDontOpen:
+            if (!expect(')', State::kIdle))
+            {
+                return false;
+            }
+            enabled_ = false;
+            return true;
+        }
+
+        return false;
+    }
+};
 
 unique_ptr<istream> get_input()
 {
@@ -31,54 +208,33 @@ unique_ptr<istream> get_input()
         return make_unique<stringstream>(kTestInput);
     }
 
-    return make_unique<ifstream>(kInputFile);
+    return make_unique<ifstream>(kInputFile, ios::binary);
 }
 
-string read_input()
+shared_ptr<const Totals> read_totals()
 {
-    auto input = get_input();
-    return parsers::String(*input);
+    return input_cache::get(kInputFile, [] {
+        auto input = get_input();
+        Scanner scanner;
+        vector<char> chunk(kChunkSize);
+        while (input->read(chunk.data(), static_cast<streamsize>(chunk.size())) || input->gcount() > 0)
+        {
+            scanner.feed({chunk.data(), static_cast<size_t>(input->gcount())});
+        }
+        return scanner.totals();
+    });
 }
 
 } // namespace
 
 string PartOne::solve()
 {
-    string input = read_input();
-
-    sregex_iterator it(input.cbegin(), input.cend(), kMulExpr);
-    sregex_iterator end{};
-    auto total = ranges::fold_left(it, end, 0ull, [&](unsigned long long acc, const smatch& m) {
-        return acc + (stoull(m[1]) * stoull(m[2]));
-    });
-    
-    return to_string(total);
+    return to_string(read_totals()->all);
 }
 
 string PartTwo::solve()
 {
-    string input = read_input();
-    bool doing = true;
-
-    sregex_iterator it(input.cbegin(), input.cend(), kMulExprWithConditionals);
-    sregex_iterator end{};
-    auto total = ranges::fold_left(it, end, 0ull, [&](unsigned long long acc, const smatch& m) {
-        if (m[0] == "do()")
-        {
-            doing = true;
-        }
-        else if (m[0] == "don't()")
-        {
-            doing = false;
-        }
-        else if (doing)
-        {
-            acc += (stoull(m[1]) * stoull(m[2]));
-        }
-        return acc;
-    });
-
-    return to_string(total);
+    return to_string(read_totals()->enabled);
 }
 
 } // namespace day03
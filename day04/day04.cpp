@@ -1,19 +1,25 @@
 #include "day04.h"
 
 #include "board.h"
+#include "input_cache.h"
 #include "parsers.h"
 #include "point.h"
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
-#include <ranges>
+#include <numeric>
+#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
+#include <version>
 
 using namespace std;
 
@@ -45,92 +51,175 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-Board read_board()
+shared_ptr<const Board> read_board()
 {
-    auto input = get_input();
-    auto board = parsers::Lines(*input, [](string s) { return vector<char>(s.cbegin(), s.cend()); });
-    return {std::move(board)};
+    return input_cache::get(kInputFile, [] {
+        auto input = get_input();
+        auto board = parsers::Lines(*input, [](string s) { return vector<char>(s.cbegin(), s.cend()); });
+        return Board{std::move(board)};
+    });
 }
 
-bool find_xmas(const Board& board, Point cur, Point dir, string_view next)
+// Cells are matched this many at a time, each block being compared
+// against shifted copies of itself one letter at a time.  The compare
+// loops are simple enough for the compiler to turn into 16- or 32-byte
+// vector compares.
+constexpr size_t kBlock = 64;
+
+using Hits = array<uint8_t, kBlock>;
+
+// Clears hits[i] wherever the cell `offset` away from cells[i] isn't `c`.
+void match(Hits& hits, const char* cells, ptrdiff_t offset, char c, size_t n)
 {
-    if (next.empty())
+    const char* shifted = cells + offset;
+    for (size_t i = 0; i < n; ++i)
     {
-        return true;
+        hits[i] &= static_cast<uint8_t>(shifted[i] == c);
     }
+}
 
-    if (!board.in_bounds(cur) || board.at(cur) != next[0])
+size_t count_hits(const Hits& hits, size_t n)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
     {
-        return false;
+        count += hits[i];
     }
+    return count;
+}
 
-    return find_xmas(board, cur + dir, dir, next.substr(1));
+/**
+ * @brief Sums count_block(cells, n) over the interior of a padded board,
+ *        in blocks of up to kBlock cells of one row.  Rows are counted in
+ *        parallel where supported.
+ */
+template <typename F>
+size_t count_blocks(const Board& padded, F&& count_block)
+{
+    const auto num_cols = static_cast<size_t>(padded.num_cols());
+
+    vector<int> rows(static_cast<size_t>(padded.num_rows()));
+    iota(rows.begin(), rows.end(), 0);
+
+    return transform_reduce(
+#if __cpp_lib_parallel_algorithm
+        execution::par,
+#endif
+        rows.begin(), rows.end(),
+        size_t{0},
+        plus{},
+        [&](int y) {
+            const char* row = &padded[padded.index_of({0, y})];
+            size_t count = 0;
+            for (size_t x = 0; x < num_cols; x += kBlock)
+            {
+                count += count_block(row + x, min(kBlock, num_cols - x));
+            }
+            return count;
+        }
+    );
 }
 
-bool find_mas_in_x_shape(const Board& board, Point cur)
+/**
+ * @brief Counts the occurrences of `word` in a straight line in any of the
+ *        eight directions.
+ *
+ * Each of the four axes is checked for both the word and its reverse,
+ * which is the same as checking all eight directions for the word.  The
+ * board is padded by one less than the word's length, so no shifted read
+ * leaves it.
+ */
+size_t count_word(const Board& board, string_view word)
 {
-    // We're looking for two MAS in an X shape
-    // for example:
-    //
-    // M   S      S   S
-    //   A    or    A
-    // M   S      M   M
-    //
-    // or similar.
-
-    // PRECONDITION: cur is not on the outermost edge of the board
-
-    char ul = board.at({cur.x() - 1, cur.y() - 1});
-    char ur = board.at({cur.x() + 1, cur.y() - 1});
-    char ll = board.at({cur.x() - 1, cur.y() + 1});
-    char lr = board.at({cur.x() + 1, cur.y() + 1});
-
-    if (board.at(cur) != 'A')
+    if (word.empty())
     {
-        return false;
+        return 0;
     }
 
-    bool ul_to_lr = ((ul == 'M' && lr == 'S') || (ul == 'S' && lr == 'M'));
-    bool ll_to_ur = ((ll == 'M' && ur == 'S') || (ll == 'S' && ur == 'M'));
+    const size_t len = word.size();
+    Board padded = board.with_border(static_cast<int>(len - 1), '\0');
+    const ptrdiff_t stride = padded.stride();
+    const array<ptrdiff_t, 4> steps{1, stride, stride + 1, stride - 1};
 
-    return ul_to_lr && ll_to_ur;
+    return count_blocks(padded, [&](const char* cells, size_t n) {
+        size_t count = 0;
+        for (ptrdiff_t step : steps)
+        {
+            Hits forward;
+            Hits backward;
+            forward.fill(1);
+            backward.fill(1);
+            for (size_t k = 0; k < len; ++k)
+            {
+                ptrdiff_t offset = static_cast<ptrdiff_t>(k) * step;
+                match(forward, cells, offset, word[k], n);
+                match(backward, cells, offset, word[len - 1 - k], n);
+            }
+            count += count_hits(forward, n) + count_hits(backward, n);
+        }
+        return count;
+    });
 }
 
-} // namespace
-
-string PartOne::solve()
+/**
+ * @brief Counts the places where `word` appears twice in an X shape,
+ *        crossing at its middle letter.  Either diagonal may read forward
+ *        or backward.
+ *
+ * For example, with "MAS":
+ *
+ * M   S      S   S
+ *   A    or    A
+ * M   S      M   M
+ */
+size_t count_crosses(const Board& board, string_view word)
 {
-    const Board board = read_board();
+    if (word.size() % 2 == 0)
+    {
+        throw logic_error{"only words with a middle letter can cross"};
+    }
 
-    vector<Point> dirs{{0, 1}, {1, 0}, {0, -1}, {-1, 0}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    size_t num_xmases = 0;
+    const size_t len = word.size();
+    const auto half = static_cast<ptrdiff_t>(len / 2);
+    Board padded = board.with_border(static_cast<int>(half), '\0');
+    const ptrdiff_t stride = padded.stride();
 
-    for (auto p : board.all_points())
-    {
-        for (auto& dir : dirs)
+    return count_blocks(padded, [&](const char* cells, size_t n) {
+        // Forward and backward along each diagonal, centered on the cell.
+        array<Hits, 4> hits;
+        for (auto& h : hits)
         {
-            num_xmases += find_xmas(board, p, dir, "XMAS") ? 1 : 0;
+            h.fill(1);
         }
-    }
 
-    return to_string(num_xmases);
-}
+        for (size_t k = 0; k < len; ++k)
+        {
+            ptrdiff_t along = static_cast<ptrdiff_t>(k) - half;
+            match(hits[0], cells, along * (stride + 1), word[k], n);
+            match(hits[1], cells, along * (stride + 1), word[len - 1 - k], n);
+            match(hits[2], cells, along * (stride - 1), word[k], n);
+            match(hits[3], cells, along * (stride - 1), word[len - 1 - k], n);
+        }
 
-string PartTwo::solve()
-{
-    const Board board = read_board();
-    auto possible_points = board.all_points() | views::filter([&](Point p) {
-        return p.x() != 0
-            && p.y() != 0
-            && p.x() != board.num_cols() - 1
-            && p.y() != board.num_rows() - 1;
+        Hits crossed;
+        for (size_t i = 0; i < n; ++i)
+        {
+            crossed[i] = static_cast<uint8_t>((hits[0][i] | hits[1][i]) & (hits[2][i] | hits[3][i]));
+        }
+        return count_hits(crossed, n);
     });
+}
 
-    auto num_x_mas = ranges::fold_left(possible_points, 0, [&](int acc, Point p) {
-        return acc + (find_mas_in_x_shape(board, p) ? 1 : 0);
-    });
+} // namespace
+
+string PartOne::solve()
+{
+    return to_string(count_word(*read_board(), "XMAS"));
+}
 
-    return to_string(num_x_mas);
+string PartTwo::solve()
+{
+    return to_string(count_crosses(*read_board(), "MAS"));
 }
 
 } // namespace day04
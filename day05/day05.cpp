@@ -1,19 +1,26 @@
 #include "day05.h"
 
+#include "input_cache.h"
 #include "parsers.h"
 
 #include <algorithm>
-#include <deque>
+#include <atomic>
+#include <cstdint>
+#include <execution>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <map>
+#include <limits>
 #include <memory>
-#include <ranges>
-#include <set>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
+#include <version>
 
 #include <boost/fusion/include/std_pair.hpp>
 #include <boost/spirit/include/qi.hpp>
@@ -71,51 +78,149 @@ unique_ptr<istream> get_input()
 using Page = int;
 using Update = vector<Page>;
 
+/**
+ * @brief The page-ordering rules, compiled into a bit matrix over densely
+ *        numbered pages.
+ *
+ * Row `p` of the matrix holds every page that some rule says must come
+ * before page `p`.  Pages that no rule mentions have no row and are never
+ * constrained.
+ */
 class Rules
 {
-    // for  each page, the set of pages that the page must appear before
-    // in a valid update.
-    map<Page, set<Page>> requirements_by_page;
+    static constexpr uint32_t kUnruled = numeric_limits<uint32_t>::max();
 
-public:
-    Rules() = default;
-    Rules(const Rules&) = default;
-    Rules(Rules&&) = default;
-
-    Rules& operator=(const Rules&) = default;
-    Rules& operator=(Rules&&) = default;
+    unordered_map<Page, uint32_t> ids_;
+    size_t words_per_row_;
+    vector<uint64_t> must_precede_;
 
-    void add_rule(Page must_come_before, Page must_come_after)
+public:
+    explicit Rules(const vector<pair<Page, Page>>& rules)
+        : ids_{}
+        , words_per_row_{0}
+        , must_precede_{}
     {
-        requirements_by_page[must_come_before].insert(must_come_after);
+        for (auto [before, after] : rules)
+        {
+            ids_.try_emplace(before, static_cast<uint32_t>(ids_.size()));
+            ids_.try_emplace(after, static_cast<uint32_t>(ids_.size()));
+        }
+
+        words_per_row_ = (ids_.size() + 63) / 64;
+        must_precede_.assign(ids_.size() * words_per_row_, 0);
+        for (auto [before, after] : rules)
+        {
+            uint32_t b = ids_.at(before);
+            must_precede_[ids_.at(after) * words_per_row_ + b / 64] |= uint64_t{1} << (b % 64);
+        }
     }
 
-    bool is_ordered(Page before, Page after)
+    /**
+     * @brief Whether no page in the update comes after one it must precede.
+     *
+     * A single pass keeps the union of the rows of every page seen so far:
+     * the pages that would be out of order if they showed up now.
+     */
+    bool is_update_valid(const Update& update) const
     {
-        const auto& requirements = requirements_by_page[after];
-        return requirements.find(before) == requirements.end();
+        thread_local vector<uint64_t> forbidden;
+        forbidden.assign(words_per_row_, 0);
+
+        for (Page page : update)
+        {
+            uint32_t id = id_of(page);
+            if (id == kUnruled)
+            {
+                continue;
+            }
+
+            if (forbidden[id / 64] & (uint64_t{1} << (id % 64)))
+            {
+                return false;
+            }
+
+            const uint64_t* row = &must_precede_[id * words_per_row_];
+            for (size_t w = 0; w < words_per_row_; ++w)
+            {
+                forbidden[w] |= row[w];
+            }
+        }
+
+        return true;
     }
 
-    bool is_update_valid(const Update& update)
+    /**
+     * @brief Returns the middle page the update would have once its pages
+     *        were put in order.
+     *
+     * This is Kahn's algorithm over the rules between the update's own
+     * pages, stopped as soon as the middle position is filled; ties go to
+     * whichever page came first in the update.
+     *
+     * The update must have an odd number of pages.  Returns nullopt if the
+     * rules between its pages are cyclic.
+     */
+    optional<Page> middle_page_when_ordered(const Update& update) const
     {
-        for (size_t i = 0; i < update.size() - 1; ++i)
+        const size_t k = update.size();
+        vector<uint32_t> ids(k);
+        ranges::transform(update, ids.begin(), [this](Page p) { return id_of(p); });
+
+        vector<size_t> num_before(k, 0);
+        for (size_t i = 0; i < k; ++i)
         {
-            for (size_t j = i + 1; j < update.size(); ++j)
+            for (size_t j = 0; j < k; ++j)
             {
-                if (!is_ordered(update[i], update[j]))
-                {
-                    return false;
-                }
+                num_before[i] += must_precede(ids[j], ids[i]);
             }
         }
 
-        return true;
+        vector<bool> placed(k, false);
+        for (size_t position = 0; ; ++position)
+        {
+            size_t i = 0;
+            while (i < k && (placed[i] || num_before[i] != 0))
+            {
+                ++i;
+            }
+            if (i == k)
+            {
+                return nullopt;
+            }
+
+            if (position == k / 2)
+            {
+                return update[i];
+            }
+
+            placed[i] = true;
+            for (size_t j = 0; j < k; ++j)
+            {
+                num_before[j] -= must_precede(ids[i], ids[j]);
+            }
+        }
+    }
+
+private:
+    uint32_t id_of(Page page) const
+    {
+        auto it = ids_.find(page);
+        return it == ids_.end() ? kUnruled : it->second;
+    }
+
+    bool must_precede(uint32_t before, uint32_t after) const
+    {
+        if (before == kUnruled || after == kUnruled)
+        {
+            return false;
+        }
+        return (must_precede_[after * words_per_row_ + before / 64] >> (before % 64)) & 1;
     }
 };
 
-pair<Rules, vector<Update>> read_input()
+pair<Rules, vector<Update>> parse_input()
 {
-    Rules rules;
+    vector<pair<Page, Page>> rules;
     vector<Update> updates;
 
     auto input = get_input();
@@ -128,66 +233,93 @@ pair<Rules, vector<Update>> read_input()
     pair<int, int> rule;
     while (*input && qi::phrase_parse(start, stop, qi::int_ >> '|' >> qi::int_, qi::space, rule))
     {
-        rules.add_rule(rule.first, rule.second);
+        rules.push_back(rule);
     }
 
     Update update;
     while (qi::phrase_parse(start, stop, qi::int_ % ',', qi::space, update))
     {
+        // Checked here rather than while summing, since an exception can't
+        // escape a parallel algorithm without terminating the process.
+        if (update.size() % 2 == 0)
+        {
+            throw runtime_error("update has no middle page");
+        }
         updates.push_back(std::move(update));
     }
 
-    return {std::move(rules), std::move(updates)};
+    return {Rules{rules}, std::move(updates)};
+}
+
+/**
+ * @brief Sums value(update) over the updates that pass `keep`, in parallel
+ *        where supported.
+ */
+template <typename Keep, typename Value>
+int sum_pages(const vector<Update>& updates, Keep&& keep, Value&& value)
+{
+    return transform_reduce(
+#if __cpp_lib_parallel_algorithm
+        execution::par,
+#endif
+        updates.begin(), updates.end(),
+        0,
+        plus{},
+        [&](const Update& update) { return keep(update) ? value(update) : 0; }
+    );
+}
+
+shared_ptr<const pair<Rules, vector<Update>>> read_input()
+{
+    return input_cache::get(kInputFile, parse_input);
 }
 
 } // namespace
 
 string PartOne::solve()
 {
-    auto [rules, updates] = read_input();
+    auto input = read_input();
+    const auto& [rules, updates] = *input;
 
     auto get_middle_page = [](const Update& update) {
-        if (update.size() % 2 == 0) throw "uh oh";
         return update[update.size() / 2];
     };
 
-    int sum = 0;
-    for (const auto& update : updates)
-    {
-        if (rules.is_update_valid(update))
-        {
-            sum += get_middle_page(update);
-        }
-
-    }
+    auto sum = sum_pages(
+        updates,
+        [&](const Update& update) { return rules.is_update_valid(update); },
+        get_middle_page
+    );
 
     return to_string(sum);
 }
 
 string PartTwo::solve()
 {
-    auto [rules, updates] = read_input();
-
-    auto is_incorrect_update = [&](const Update& update) {
-        return !rules.is_update_valid(update);
-    };
-
-    auto sort_update = [&](Update& update) {
-        sort(update.begin(), update.end(), [&](Page lhs, Page rhs) { return rules.is_ordered(lhs, rhs); });
-        return update;
-    };
-
-    auto get_middle_page = [](const Update& update) {
-        if (update.size() % 2 == 0) throw "uh oh";
-        return update[update.size() / 2];
-    };
+    auto input = read_input();
+    const auto& [rules, updates] = *input;
+
+    atomic<bool> cyclic{false};
+    auto sum = sum_pages(
+        updates,
+        [&](const Update& update) { return !rules.is_update_valid(update); },
+        [&](const Update& update) {
+            auto page = rules.middle_page_when_ordered(update);
+            if (!page)
+            {
+                cyclic = true;
+                return 0;
+            }
+            return *page;
+        }
+    );
 
-    auto fixed_incorrect_updates = updates
-        | views::filter(is_incorrect_update)
-        | views::transform(sort_update)
-        | views::transform(get_middle_page);
+    if (cyclic)
+    {
+        throw runtime_error("an update's rules are cyclic");
+    }
 
-    return to_string(ranges::fold_left(fixed_incorrect_updates, 0, plus<>{}));
+    return to_string(sum);
 }
 
 } // namespace day05
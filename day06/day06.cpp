@@ -1,19 +1,21 @@
 #include "day06.h"
 
 #include "board.h"
+#include "input_cache.h"
 #include "parsers.h"
 #include "point.h"
-#include "turtle.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <execution>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <version>
@@ -50,13 +52,6 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-Board read_board()
-{
-    auto input = get_input();
-    auto lines = parsers::Lines(*input, parsers::Chars);
-    return {lines};
-}
-
 Point find_start(const Board& board)
 {
     auto start = board.all_points() | views::filter([&](Point p) { return board.at(p) == '^'; });
@@ -67,87 +62,271 @@ Point find_start(const Board& board)
     return *start.begin();
 }
 
-struct WalkResult
+/**
+ * @brief A set of guard states, stored as a dense bitmap.
+ *
+ * Remembers which words it has dirtied, so that clearing costs only as much
+ * as the walk that filled it rather than the size of the whole map.
+ */
+class StateSet
 {
-    unordered_set<Turtle> visited;
-    bool loop_detected;
+    vector<uint64_t> bits_;
+    vector<size_t> touched_;
+
+public:
+    void resize(size_t num_states)
+    {
+        bits_.assign((num_states + 63) / 64, 0);
+        touched_.clear();
+    }
+
+    size_t capacity() const
+    {
+        return bits_.size() * 64;
+    }
+
+    // Returns false if the state was already present.
+    bool insert(size_t state)
+    {
+        uint64_t& word = bits_[state / 64];
+        uint64_t bit = uint64_t{1} << (state % 64);
+        if (word & bit)
+        {
+            return false;
+        }
+
+        if (word == 0)
+        {
+            touched_.push_back(state / 64);
+        }
+        word |= bit;
+        return true;
+    }
 
-    size_t size() const
+    void clear()
     {
-        return visited.size();
+        for (auto ix : touched_)
+        {
+            bits_[ix] = 0;
+        }
+        touched_.clear();
     }
 };
 
-WalkResult walk(const Board& board, Point start, Point dir, Point obstacle = Point{-1, -1})
+/**
+ * @brief The guard's map, set up for fast patrol simulation.
+ *
+ * Cells are indices into a copy of the map with a one-cell border of
+ * kOutside, and directions are numbered UP, RIGHT, DOWN, LEFT so that
+ * turning right is adding one.  For every (cell, direction) we precompute
+ * where the guard stops in front of the next obstacle, so patrols move a
+ * whole segment at a time.
+ */
+class Lab
 {
-    unordered_set<Turtle> visited;
+public:
+    using Cell = uint32_t;
 
-    Turtle cur{start, dir};
-    while (board.in_bounds(cur.position()))
+    struct State
     {
-        auto [_, did_insert] = visited.insert(cur);
-        if (!did_insert)
+        Cell cell;
+        uint32_t dir;
+
+        size_t index() const
         {
-            // loop detected
-            return {visited, true};
+            return static_cast<size_t>(cell) * 4 + dir;
         }
+    };
+
+    // The guard leaves the map instead of stopping.
+    static constexpr Cell kExit = numeric_limits<Cell>::max();
 
-        Point next = cur.position() + cur.direction();
-        if (!board.in_bounds(next))
+private:
+    static constexpr char kOutside = '~';
+
+    Board board_;
+    array<size_t, 4> step_;
+    vector<Cell> jump_;
+    State start_;
+
+public:
+    explicit Lab(const Board& board)
+        : board_(board.with_border(1, kOutside))
+        , step_{
+            static_cast<size_t>(-board_.stride()),
+            1,
+            static_cast<size_t>(board_.stride()),
+            static_cast<size_t>(-1),
+        }
+        , jump_(board_.buffer_size() * 4, kExit)
+        , start_{static_cast<Cell>(board_.index_of(find_start(board))), 0}
+    {
+        // Fill each direction's table starting from the far wall, so that
+        // every cell can copy its answer from the next cell along.
+        for (uint32_t dir = 0; dir < 4; ++dir)
         {
-            // we're done
-            break;
+            bool descending = dir == 1 || dir == 2;
+            for (size_t i = 0; i < board_.buffer_size(); ++i)
+            {
+                size_t c = descending ? board_.buffer_size() - 1 - i : i;
+                if (board_[c] == '#' || board_[c] == kOutside)
+                {
+                    continue;
+                }
+
+                size_t next = c + step_[dir];
+                if (board_[next] == '#')
+                {
+                    jump_[c * 4 + dir] = static_cast<Cell>(c);
+                }
+                else if (board_[next] != kOutside)
+                {
+                    jump_[c * 4 + dir] = jump_[next * 4 + dir];
+                }
+            }
         }
+    }
 
-        if (board[next] == '#' || next == obstacle)
+    size_t num_states() const
+    {
+        return board_.buffer_size() * 4;
+    }
+
+    /**
+     * @brief Walks the unobstructed patrol one cell at a time.
+     *
+     * Returns every cell the guard enters after leaving the start, in the
+     * order first entered, paired with the guard's state just before
+     * stepping into it.
+     */
+    vector<pair<Cell, State>> first_visits() const
+    {
+        vector<bool> seen(board_.buffer_size(), false);
+        vector<pair<Cell, State>> visits;
+
+        seen[start_.cell] = true;
+        State cur = start_;
+        for (size_t moves = 0; moves <= num_states(); ++moves)
         {
-            cur = cur.turn_right();
+            size_t next = cur.cell + step_[cur.dir];
+            if (board_[next] == kOutside)
+            {
+                return visits;
+            }
+
+            if (board_[next] == '#')
+            {
+                cur.dir = (cur.dir + 1) % 4;
+                continue;
+            }
+
+            if (!seen[next])
+            {
+                seen[next] = true;
+                visits.push_back({static_cast<Cell>(next), cur});
+            }
+            cur.cell = static_cast<Cell>(next);
         }
-        else
+
+        throw logic_error{"the guard never leaves"};
+    }
+
+    /**
+     * @brief Returns true if a guard starting in state `from` patrols
+     *        forever once an extra obstacle is placed on `obstacle`.
+     *
+     * `seen` is scratch space, left empty on return.
+     */
+    bool loops(State from, Cell obstacle, StateSet& seen) const
+    {
+        if (seen.capacity() < num_states())
         {
-            cur = cur.move_forward();
+            seen.resize(num_states());
         }
+
+        bool result = false;
+        State cur = from;
+        while (true)
+        {
+            if (!seen.insert(cur.index()))
+            {
+                result = true;
+                break;
+            }
+
+            Cell stop = jump_[cur.index()];
+            if (auto d = steps_to(cur, obstacle); d && (stop == kExit || *d <= *steps_to(cur, stop)))
+            {
+                stop = static_cast<Cell>(obstacle - step_[cur.dir]);
+            }
+            else if (stop == kExit)
+            {
+                break;
+            }
+
+            cur = {stop, (cur.dir + 1) % 4};
+        }
+
+        seen.clear();
+        return result;
     }
 
-    return {std::move(visited), false};
+private:
+    // How many steps it takes to reach `target` going straight ahead from
+    // `s`, or nullopt if it isn't ahead.
+    optional<size_t> steps_to(State s, Cell target) const
+    {
+        auto stride = static_cast<size_t>(board_.stride());
+        size_t r0 = s.cell / stride, c0 = s.cell % stride;
+        size_t r1 = target / stride, c1 = target % stride;
+
+        switch (s.dir)
+        {
+        case 0: if (c0 == c1 && r1 <= r0) return r0 - r1; break;
+        case 1: if (r0 == r1 && c1 >= c0) return c1 - c0; break;
+        case 2: if (c0 == c1 && r1 >= r0) return r1 - r0; break;
+        case 3: if (r0 == r1 && c1 <= c0) return c0 - c1; break;
+        }
+        return nullopt;
+    }
+};
+
+shared_ptr<const Lab> read_lab()
+{
+    return input_cache::get(kInputFile, [] {
+        auto input = get_input();
+        auto lines = parsers::Lines(*input, parsers::Chars);
+        return Lab{Board{std::move(lines)}};
+    });
 }
 
 } // namespace
 
 string PartOne::solve()
 {
-    auto board = read_board();
-    auto start = find_start(board);
-    auto result = walk(board, start, Dir::UP);
-    auto positions = result.visited
-        | views::transform(&Turtle::position)
-        | ranges::to<unordered_set>();
-
-    return to_string(positions.size());
+    const Lab& lab = *read_lab();
+
+    // Every visited cell, plus the one the guard started on.
+    return to_string(lab.first_visits().size() + 1);
 }
 
 string PartTwo::solve()
 {
-    auto board = read_board();
-    auto start = find_start(board);
-    auto simple_path = walk(board, start, Dir::UP).visited;
-
-    auto simple_path_points = simple_path
-        | views::transform(&Turtle::position)
-        | views::filter([&](Point p) { return p != start; })
-        | ranges::to<unordered_set>();
-
+    const Lab& lab = *read_lab();
+    auto visits = lab.first_visits();
 
+    // The guard's path is unchanged up to the first time it would walk into
+    // the new obstacle, so each candidate's walk starts right there.
     auto num_loops = transform_reduce(
 #if __cpp_lib_parallel_algorithm
-        execution::par_unseq,
+        execution::par,
 #endif
-        simple_path_points.begin(), simple_path_points.end(),
+        visits.begin(), visits.end(),
         0,
         plus<>{},
-        [&](Point p) {
-            auto result = walk(board, start, Dir::UP, p);
-            return result.loop_detected ? 1 : 0;;
+        [&](const pair<Lab::Cell, Lab::State>& visit) {
+            thread_local StateSet seen;
+            return lab.loops(visit.second, visit.first, seen) ? 1 : 0;
         }
     );
 
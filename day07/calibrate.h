@@ -0,0 +1,59 @@
+#pragma once
+
+#include "numbers.h"
+
+#include <cstdint>
+#include <span>
+
+namespace day07
+{
+
+/**
+ * @brief Returns true if some choice of operators, applied left to right,
+ *        turns `values` into `expected`.
+ *
+ * The operators are + and *, plus || (decimal concatenation) if
+ * `allow_concat` is set.  Rather than trying every combination going
+ * forward, this peels operands off the right-hand end: the last operator
+ * can only have been + if the last operand fits under the target, * if it
+ * divides it, and || if the target ends in its digits.  Each of those
+ * leaves a smaller target for the remaining operands, and most branches
+ * die immediately.
+ */
+inline bool can_calibrate(std::uintmax_t expected, std::span<const std::uintmax_t> values, bool allow_concat)
+{
+    if (values.empty())
+    {
+        return false;
+    }
+
+    std::uintmax_t last = values.back();
+    auto rest = values.first(values.size() - 1);
+    if (rest.empty())
+    {
+        return expected == last;
+    }
+
+    if (expected >= last && can_calibrate(expected - last, rest, allow_concat))
+    {
+        return true;
+    }
+
+    if (last == 0 ? expected == 0 : (expected % last == 0 && can_calibrate(expected / last, rest, allow_concat)))
+    {
+        return true;
+    }
+
+    if (allow_concat)
+    {
+        auto shift = Numbers::shl10(std::uintmax_t{1}, Numbers::count_digits(last));
+        if (expected % shift == last && can_calibrate(expected / shift, rest, allow_concat))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace day07
@@ -1,12 +1,14 @@
 #include "day07.h"
 
-#include "numbers.h"
+#include "calibrate.h"
+#include "input_cache.h"
 #include "parsers.h"
 
 #include <algorithm>
 #include <execution>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <numeric>
 #include <ranges>
 #include <sstream>
@@ -26,38 +28,6 @@ namespace day07
 namespace
 {
 
-enum class OpType
-{
-    Add = 0,
-    Mul = 1,
-    Concat = 2
-};
-
-uintmax_t eval_op(uintmax_t lhs, uintmax_t rhs, OpType op)
-{
-    switch (op)
-    {
-    case OpType::Add:
-        return lhs + rhs;
-    case OpType::Mul:
-        return lhs * rhs;
-    case OpType::Concat:
-    {
-        auto digits = Numbers::count_digits(rhs);
-        return Numbers::shl10(lhs, digits) + rhs;
-        // uintmax_t tmp = rhs;
-        // while (tmp > 0)
-        // {
-        //     lhs *= 10;
-        //     tmp /= 10;
-        // }
-        // return lhs + rhs;
-    }
-    default:
-        throw "Invalid op";
-    }
-}
-
 struct Calibration
 {
     uintmax_t expected;
@@ -69,57 +39,7 @@ struct Calibration
 
     bool find_valid_ops(int num_ops) const
     {
-        vector<OpType> possible;
-        possible.resize(values.size() - 1, OpType::Add);
-
-        // early exit: any of the numbers are bigger than the expected result
-        if (ranges::any_of(values, [this](uintmax_t value) { return value > expected; }))
-        {
-            return false;
-        }
-
-        // constraint: the last op can be concat iff the expected result, as a string,
-        //             ends with the last number.
-        bool last_op_concat = to_string(expected).ends_with(to_string(values.back()));
-
-        do
-        {
-            uintmax_t result = values[0];
-            for (size_t i = 1; i < values.size(); ++i)
-            {
-                result = eval_op(result, values[i], possible[i - 1]);
-                if (result > expected)
-                {
-                    break;
-                }
-            }
-
-            if (result == expected)
-            {
-                return true;
-            }
-        }
-        while (permute(possible, num_ops, last_op_concat));
-
-        return false;
-    }
-
-    bool permute(vector<OpType>& possible, int ceiling, bool last_op_concat) const
-    {
-        for (size_t i = 0; i < possible.size(); ++i)
-        {
-            possible[i] = static_cast<OpType>((static_cast<int>(possible[i]) + 1) % ceiling);
-            if (i == possible.size() - 1 && !last_op_concat && possible.back() == OpType::Concat)
-            {
-                possible[i] = OpType::Add;
-            }
-            else if (possible[i] != OpType::Add)
-            {
-                return true;
-            }
-        }
-
-        return ranges::any_of(possible, [](OpType op) { return op != OpType::Add; });
+        return can_calibrate(expected, values, num_ops > 2);
     }
 };
 
@@ -145,7 +65,7 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-vector<Calibration> read_input()
+vector<Calibration> parse_input()
 {
     auto input = get_input();
     *input >> ws;
@@ -165,11 +85,17 @@ vector<Calibration> read_input()
     return calibrations;
 }
 
+shared_ptr<const vector<Calibration>> read_input()
+{
+    return input_cache::get(kInputFile, parse_input);
+}
+
 } // namespace
 
 string PartOne::solve()
 {
-    auto valid_calibrations = read_input()
+    auto calibrations = read_input();
+    auto valid_calibrations = *calibrations
         | views::filter([](const Calibration& c) { return c.find_valid_ops(2); })
         | views::transform(&Calibration::expected);
 
@@ -188,7 +114,7 @@ string PartOne::solve()
 
 string PartTwo::solve()
 {
-    auto all_calibrations = read_input();
+    const auto& all_calibrations = *read_input();
 
     uintmax_t sum = transform_reduce(
 #if __cpp_lib_parallel_algorithm
@@ -4,12 +4,11 @@
 #include "point.h"
 
 #include <algorithm>
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <ranges>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -38,14 +37,14 @@ constexpr const char* kTestInput = R"(............
 ............
 ............)";
 
-unique_ptr<istream> get_input()
+MappedFile open_input()
 {
     if (g_test_input)
     {
-        return make_unique<stringstream>(kTestInput);
+        return MappedFile::wrap(kTestInput);
     }
 
-    return make_unique<ifstream>(kInputFile);
+    return MappedFile{kInputFile};
 }
 
 struct Puzzle
@@ -153,13 +152,13 @@ ostream& operator<<(ostream& out, const Puzzle& p)
 
 Puzzle read_input()
 {
-    auto input = get_input();
-    
+    auto input = open_input();
+
     Puzzle puzzle;
 
     int num_lines = 0;
     size_t width = 0;
-    for (const auto& line : parsers::Lines(*input))
+    for (string_view line : parsers::Lines(input))
     {
         width = std::max(width, line.size());
         for (size_t i = 0; i < line.size(); i++)
@@ -3,16 +3,17 @@
 #include "parsers.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
-#include <numeric>
-#include <ranges>
+#include <queue>
 #include <sstream>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -24,41 +25,40 @@ namespace day09
 namespace
 {
 
-class Block
-{
-    int id_;
-
-public:
-    Block() : id_(-1) {} // default to empty space; -1 means empty space
-    Block(int id) : id_(id) {}
-
-    bool is_space() const
-    {
-        return id_ == -1;
-    }
+// The longest run of blocks the compact map can describe with one digit.
+constexpr size_t kMaxSpan = 9;
 
-    int id() const
-    {
-        return id_;
-    }
-
-    void set_id(int id)
-    {
-        id_ = id;
-    }
+/**
+ * @brief A run of contiguous blocks on the disk.
+ *
+ * For files, `id` is the file ID; gaps leave it unused.
+ */
+struct Extent
+{
+    size_t id;
+    uintmax_t start;
+    uintmax_t length;
 };
 
-using Blocks = vector<Block>;
-
+/**
+ * @brief A disk modeled as runs of blocks rather than individual blocks.
+ *
+ * Files are kept as extents in ascending ID order (more than one per ID
+ * once compact() has split them), and free space as gaps in disk order.
+ * Nothing here costs more than the number of runs, no matter how many
+ * blocks the disk has.
+ */
 class HardDrive
 {
-    Blocks blocks_;
+    vector<Extent> files_;
+    vector<Extent> gaps_;
 
 public:
-    HardDrive(Blocks&& files_and_space)
-        : blocks_(std::move(files_and_space))
+    HardDrive(vector<Extent>&& files, vector<Extent>&& gaps)
+        : files_(std::move(files))
+        , gaps_(std::move(gaps))
     {
-        if (blocks_.empty())
+        if (files_.empty())
         {
             throw invalid_argument{"Empty hard drive"};
         }
@@ -72,107 +72,99 @@ public:
 
     void compact()
     {
-        size_t s = 0;
-        size_t f = blocks_.size() - 1;
+        // Fill gaps from the left with blocks taken from the rightmost
+        // files, splitting files as needed.  Space freed at the right end
+        // is never filled again, so it needn't be tracked.
+        vector<Extent> moved;
+        size_t g = 0;
 
-        while (s < f)
+        for (auto file = files_.rbegin(); file != files_.rend(); ++file)
         {
-            while (s < blocks_.size() && !blocks_[s].is_space())
+            while (file->length > 0 && g < gaps_.size() && gaps_[g].start < file->start)
             {
-                ++s;
-            }
+                Extent& gap = gaps_[g];
+                uintmax_t n = min(gap.length, file->length);
+                moved.push_back({file->id, gap.start, n});
 
-            while (f > s && blocks_[f].is_space())
-            {
-                --f;
-            }
+                gap.start += n;
+                gap.length -= n;
+                file->length -= n;
 
-            if (s < f)
-            {
-                swap(blocks_[s], blocks_[f]);
+                if (gap.length == 0)
+                {
+                    ++g;
+                }
             }
         }
+
+        erase_if(files_, [](const Extent& file) { return file.length == 0; });
+        files_.insert(files_.end(), moved.begin(), moved.end());
+        gaps_.clear();
     }
 
     void defragment()
     {
-        unordered_set<int> moved_files;
-
-        for (size_t f = blocks_.size() - 1; f < blocks_.size(); --f)
+        // One min-heap of gap starts per gap length.  Moving a file into a
+        // gap leaves a shorter gap at a later start, and the space a file
+        // vacates lies right of every file still to be moved, so it never
+        // needs to go back in.
+        array<priority_queue<uintmax_t, vector<uintmax_t>, greater<>>, kMaxSpan + 1> gaps_by_length;
+        for (const auto& gap : gaps_)
         {
-            while (blocks_[f].is_space() || moved_files.find(blocks_[f].id()) != moved_files.end())
+            if (gap.length > kMaxSpan)
             {
-                --f;
+                throw invalid_argument{"Gap too long"};
             }
+            gaps_by_length[gap.length].push(gap.start);
+        }
 
-            if (f == numeric_limits<size_t>::max())
+        for (auto file = files_.rbegin(); file != files_.rend(); ++file)
+        {
+            // find the left-most gap that will fit the file.
+            size_t best = 0;
+            for (size_t len = file->length; len <= kMaxSpan; ++len)
             {
-                break;
+                auto& heap = gaps_by_length[len];
+                if (!heap.empty() && heap.top() < file->start
+                    && (best == 0 || heap.top() < gaps_by_length[best].top()))
+                {
+                    best = len;
+                }
             }
 
-            // at this point, f is at the (rightmost) edge of a file.  count how big the file is.
-            int cur_id = blocks_[f].id();
-            size_t block_size = 0;
-            while (f != numeric_limits<size_t>::max() && blocks_[f].id() == cur_id)
+            if (best == 0)
             {
-                --f;
-                ++block_size;
+                continue;
             }
 
-            // f is no longer pointed at the last block of the file; it's now pointed at the first block of the next file.
-            ++f;
-
-            // CONDITION: block_size >= 1
-
-            // now we know how big the file is; find the left-most block of spaces that will fit it.
-            for (size_t s = 0; s < f; s++)
+            uintmax_t start = gaps_by_length[best].top();
+            gaps_by_length[best].pop();
+            if (best > file->length)
             {
-                size_t found = 0;
-                while (s + found < f && blocks_[s + found].is_space() && found < block_size)
-                {
-                    ++found;
-                }
-
-                if (found == block_size)
-                {
-                    // we found a contiguous block of spaces that will fit the file.  move the file there.
-                    for (size_t i = 0; i < block_size; ++i)
-                    {
-                        blocks_[s + i].set_id(cur_id);
-                        blocks_[f + i].set_id(-1);
-                    }
-
-                    break;
-                }
-
-                // skip any spaces we found (the for-loop will move s past them)
-                s += found;
+                gaps_by_length[best - file->length].push(start + file->length);
             }
-
-            moved_files.insert(cur_id);
+            file->start = start;
         }
+
+        gaps_.clear();
     }
 
     uintmax_t checksum() const
     {
         uintmax_t sum = 0;
-        for (size_t i = 0; i < blocks_.size(); ++i)
+        for (const auto& [id, start, length] : files_)
         {
-            // logging is slow, so only do it when we're debugging at -vvv
-            dbg(LogLevel::TRACE) << " i=" << i << " block=" << blocks_[i].id() << " sum=" << sum << endl;
+            dbg(LogLevel::TRACE) << " id=" << id << " start=" << start << " length=" << length << " sum=" << sum << endl;
 
-            if (blocks_[i].is_space())
-            {
-                continue;
-            }
-
-            size_t mul = static_cast<size_t>(blocks_[i].id()) * i;
-            if (sum + mul < sum)
+            // id * (start + (start + 1) + ... + (start + length - 1))
+            uintmax_t positions = length * start + length * (length - 1) / 2;
+            uintmax_t term = static_cast<uintmax_t>(id) * positions;
+            if ((id != 0 && term / id != positions) || sum + term < sum)
             {
                 throw overflow_error{"Overflow"};
             }
 
-            sum += mul;
+            sum += term;
         }
         return sum;
     }
@@ -192,31 +184,32 @@ HardDrive make_from_repr(const string& repr)
     // PRECONDITION: No contiguous group of file or space blocks with more than 9 blocks.
     // PRECONDITION: Files are contiguous (that is, not fragmented).
 
-    size_t num_blocks = accumulate(
-        repr.begin(), repr.end(),
-        0_z,
-        [](size_t acc, char c) { return acc + static_cast<size_t>(c - '0'); }
-    );
-
-    Blocks blocks(num_blocks);
+    // ignore the trailing newline, if any
+    size_t size = repr.find_last_not_of(" \t\n") + 1;
 
-    int file_id = 0;
-    size_t it = 0;
+    vector<Extent> files;
+    vector<Extent> gaps;
+    files.reserve(size / 2 + 1);
+    gaps.reserve(size / 2);
 
-    for (size_t i = 0; i < repr.size(); i += 2)
+    uintmax_t pos = 0;
+    for (size_t i = 0; i < size; ++i)
     {
-        for (int n = repr[i] - '0'; n > 0; --n)
+        auto length = static_cast<uintmax_t>(repr[i] - '0');
+        if (length > kMaxSpan)
         {
-            blocks[it++].set_id(file_id);
+            throw invalid_argument{"Invalid compact map"};
         }
 
-        // adjust for spaces
-        it += static_cast<size_t>(repr[i + 1] - '0');
-
-        file_id++;
+        if (length > 0)
+        {
+            auto& extents = i % 2 == 0 ? files : gaps;
+            extents.push_back({i / 2, pos, length});
+        }
+        pos += length;
     }
 
-    return HardDrive{std::move(blocks)};
+    return HardDrive{std::move(files), std::move(gaps)};
 }
 
 constexpr const char* kInputFile = "day09/day09.input";
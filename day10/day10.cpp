@@ -1,6 +1,7 @@
 #include "day10.h"
 
 #include "board.h"
+#include "input_cache.h"
 #include "parsers.h"
 #include "point.h"
 
@@ -47,11 +48,13 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-Board read_board()
+shared_ptr<const Board> read_board()
 {
-    auto input = get_input();
-    auto lines = parsers::Lines(*input, parsers::Chars);
-    return {std::move(lines)};
+    return input_cache::get(kInputFile, [] {
+        auto input = get_input();
+        auto lines = parsers::Lines(*input, parsers::Chars);
+        return Board{std::move(lines)};
+    });
 }
 
 struct TrailHash
@@ -125,7 +128,7 @@ TrailSet find_all_trails(const Board& board)
 
 string PartOne::solve()
 {
-    auto board = read_board();
+    const Board& board = *read_board();
     auto trails = find_all_trails(board);
 
     unordered_map<Point, unordered_set<Point>> nines_by_trailheads;
@@ -145,7 +148,7 @@ string PartOne::solve()
 
 string PartTwo::solve()
 {
-    auto board = read_board();
+    const Board& board = *read_board();
     auto trails = find_all_trails(board);
 
     return to_string(trails.size());
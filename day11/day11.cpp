@@ -1,18 +1,15 @@
 #include "day11.h"
 
-#include "hash.h"
-
 #include <algorithm>
-#include <cmath>
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
-#include <numeric>
-#include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -29,62 +26,178 @@ constexpr const char* kTestInput = "125 17";
 
 using Stone = uintmax_t;
 
+constexpr auto kPowersOfTen = [] {
+    array<Stone, numeric_limits<Stone>::digits10 + 1> powers{};
+    Stone p = 1;
+    for (auto& power : powers)
+    {
+        power = p;
+        p *= 10;
+    }
+    return powers;
+}();
+
+uintmax_t checked_add(uintmax_t a, uintmax_t b)
+{
+    if (a > numeric_limits<uintmax_t>::max() - b)
+    {
+        throw overflow_error{"Overflow"};
+    }
+    return a + b;
+}
+
 int count_digits(Stone num)
 {
-    int digits = 0;
-    while (num > 0)
+    int digits = 1;
+    while (static_cast<size_t>(digits) < kPowersOfTen.size() && num >= kPowersOfTen[static_cast<size_t>(digits)])
     {
-        num /= 10;
         ++digits;
     }
     return digits;
 }
 
-struct Hash
+/**
+ * @brief A histogram of stone values, in an open-addressing hash table.
+ *
+ * Slots are (stone, count) pairs in one flat array with linear probing,
+ * so a generation with N distinct stones touches O(N) contiguous memory.
+ * clear() keeps the capacity, so reusing a histogram doesn't allocate.
+ */
+class StoneCounts
 {
-    size_t operator()(const tuple<Stone, uintmax_t>& t) const
+    // No stone can ever hold this value; it marks unused slots.
+    static constexpr Stone kEmpty = numeric_limits<Stone>::max();
+
+    vector<pair<Stone, uintmax_t>> slots_;
+    size_t size_;
+    // 64 - log2(slots_.size()); selects the top bits of the hash.
+    int shift_;
+
+public:
+    StoneCounts()
+        : slots_(16, {kEmpty, 0})
+        , size_(0)
+        , shift_(60)
     {
-        size_t seed = 1;
-        hash_combine(seed, get<0>(t));
-        hash_combine(seed, get<1>(t));
-        return seed;
     }
-};
 
-using BlinkCache = unordered_map<tuple<Stone, uintmax_t>, uintmax_t, Hash>;
+    void add(Stone stone, uintmax_t count)
+    {
+        if ((size_ + 1) * 2 > slots_.size())
+        {
+            grow();
+        }
 
-uintmax_t blink(Stone s, uintmax_t num_blinks_remaining, BlinkCache& cache)
-{
-    tuple<Stone, uintmax_t> key{s, num_blinks_remaining};
-    if (auto it = cache.find(key); it != cache.end())
+        auto& slot = find(stone);
+        if (slot.first == kEmpty)
+        {
+            slot = {stone, 0};
+            ++size_;
+        }
+        slot.second = checked_add(slot.second, count);
+    }
+
+    void clear()
+    {
+        fill(slots_.begin(), slots_.end(), pair{kEmpty, uintmax_t{0}});
+        size_ = 0;
+    }
+
+    size_t size() const
     {
-        return it->second;
+        return size_;
     }
 
-    if (num_blinks_remaining == 0)
+    template <typename F>
+    void for_each(F&& f) const
     {
-        cache[key] = 1;
-        return 1;
+        for (const auto& [stone, count] : slots_)
+        {
+            if (stone != kEmpty)
+            {
+                f(stone, count);
+            }
+        }
+    }
+
+private:
+    pair<Stone, uintmax_t>& find(Stone stone)
+    {
+        // Fibonacci hashing: the high bits of the product depend on every
+        // bit of the stone, so take those rather than the low bits.
+        size_t mask = slots_.size() - 1;
+        size_t ix = static_cast<size_t>((static_cast<uint64_t>(stone) * 0x9E3779B97F4A7C15ull) >> shift_);
+        while (slots_[ix].first != kEmpty && slots_[ix].first != stone)
+        {
+            ix = (ix + 1) & mask;
+        }
+        return slots_[ix];
     }
 
-    if (s == 0)
+    void grow()
     {
-        uintmax_t result = blink(1, num_blinks_remaining - 1, cache);
-        return cache[key] = result;
+        vector<pair<Stone, uintmax_t>> old(slots_.size() * 2, {kEmpty, 0});
+        swap(old, slots_);
+        --shift_;
+        for (const auto& [stone, count] : old)
+        {
+            if (stone != kEmpty)
+            {
+                find(stone) = {stone, count};
+            }
+        }
     }
+};
 
-    int digits = count_digits(s);
-    if (digits % 2 == 0)
+/**
+ * @brief Returns how many stones there are after `num_blinks` blinks.
+ *
+ * Stones with the same value always evolve the same way, so each
+ * generation is just a count per distinct value.  This runs in a loop
+ * over generations, so any number of blinks is safe; memory depends only
+ * on how many distinct values appear.  Throws overflow_error if a stone
+ * value or the count of stones no longer fits in 64 bits.
+ */
+uintmax_t count_stones(const vector<Stone>& stones, size_t num_blinks)
+{
+    StoneCounts cur;
+    StoneCounts next;
+    for (Stone s : stones)
     {
-        Stone divisor = static_cast<Stone>(pow(10, digits / 2));
-        Stone first = s / divisor;
-        Stone second = s % divisor;
-        return cache[key] =
-            blink(first, num_blinks_remaining - 1, cache) +
-            blink(second, num_blinks_remaining - 1, cache);
+        cur.add(s, 1);
     }
 
-    return cache[key] = blink(s * 2024, num_blinks_remaining - 1, cache);
+    for (size_t blink = 0; blink < num_blinks; ++blink)
+    {
+        next.clear();
+        cur.for_each([&](Stone s, uintmax_t count) {
+            if (s == 0)
+            {
+                next.add(1, count);
+                return;
+            }
+
+            int digits = count_digits(s);
+            if (digits % 2 == 0)
+            {
+                Stone divisor = kPowersOfTen[static_cast<size_t>(digits / 2)];
+                next.add(s / divisor, count);
+                next.add(s % divisor, count);
+                return;
+            }
+
+            if (s > (numeric_limits<Stone>::max() - 1) / 2024)
+            {
+                throw overflow_error{"Overflow"};
+            }
+            next.add(s * 2024, count);
+        });
+        swap(cur, next);
+    }
+
+    uintmax_t total = 0;
+    cur.for_each([&](Stone, uintmax_t count) { total = checked_add(total, count); });
+    return total;
 }
 
 [[maybe_unused]]
@@ -115,39 +228,13 @@ vector<Stone> read_stones()
 string PartOne::solve()
 {
     auto stones = read_stones();
-
-    uintmax_t num_blinks = 25;
-    BlinkCache cache;
-
-    uintmax_t num_stones = transform_reduce(
-        stones.begin(), stones.end(),
-        static_cast<uintmax_t>(0),
-        plus<>{},
-        [&](Stone s) {
-            return blink(s, num_blinks, cache);
-        }
-    );
-
-    return to_string(num_stones);
+    return to_string(count_stones(stones, 25));
 }
 
 string PartTwo::solve()
 {
     auto stones = read_stones();
-
-    uintmax_t num_blinks = 75;
-    BlinkCache cache;
-
-    uintmax_t num_stones = transform_reduce(
-        stones.begin(), stones.end(),
-        static_cast<uintmax_t>(0),
-        plus<>{},
-        [&](Stone s) {
-            return blink(s, num_blinks, cache);
-        }
-    );
-
-    return to_string(num_stones);
+    return to_string(count_stones(stones, 75));
 }
 
 } // namespace day11
@@ -1,26 +1,24 @@
 #include "day12.h"
 
 #include "board.h"
+#include "input_cache.h"
 #include "parsers.h"
 #include "point.h"
 
 #include <algorithm>
-#include <cassert>
-#include <deque>
+#include <cstdint>
 #include <exception>
 #include <execution>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <numeric>
-#include <ranges>
-#include <set>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <thread>
 #include <utility>
 #include <vector>
+#include <version>
 
 using namespace std;
 
@@ -63,267 +61,188 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-shared_ptr<Board> read_board()
+shared_ptr<const Board> read_board()
 {
-    auto input = get_input();
-    auto lines = parsers::Lines(*input, parsers::Chars);
-
-    return make_shared<Board>(std::move(lines));
+    return input_cache::get(kInputFile, [] {
+        auto input = get_input();
+        auto lines = parsers::Lines(*input, parsers::Chars);
+        return Board{std::move(lines)};
+    });
 }
 
-class UnionFind
+/**
+ * @brief Labels a garden's regions in one raster scan, totting up each
+ *        region's area, perimeter and corners as it goes.
+ *
+ * Cells are indices into a copy of the board with a one-cell border.
+ * Labels live in a union-find over those indices, and every root carries
+ * its region's running totals in flat arrays; uniting two regions adds
+ * their totals together.  A cell's own contribution only depends on its
+ * 3x3 neighborhood, so nothing ever needs a per-region container.  A
+ * region has as many corners as sides.
+ *
+ * The rows can be split into bands that are labeled independently (and in
+ * parallel, where supported), then stitched together along the band
+ * boundaries.
+ */
+class Garden
 {
-    vector<size_t> parent_;
-    vector<size_t> rank_;
-    int num_rows_;
-    int num_cols_;
+    Board board_;
+    vector<uint32_t> parent_;
+    vector<uint32_t> area_;
+    vector<uint32_t> perimeter_;
+    vector<uint32_t> corners_;
 
 public:
-    UnionFind(int num_rows, int num_cols)
-        : parent_(static_cast<size_t>(num_rows * num_cols))
-        , rank_(static_cast<size_t>(num_rows * num_cols), 1)
-        , num_rows_(num_rows)
-        , num_cols_(num_cols)
+    explicit Garden(const Board& board, size_t num_bands = 1)
+        : board_(board.with_border(1, '\0'))
+        , parent_(board_.buffer_size())
+        , area_(board_.buffer_size(), 0)
+        , perimeter_(board_.buffer_size(), 0)
+        , corners_(board_.buffer_size(), 0)
     {
         iota(parent_.begin(), parent_.end(), 0);
-    }
-
-    Point find(Point p)
-    {
-        if (!in_bounds(p))
-        {
-            return {-1, -1};
-        }
-
-        size_t i = point_to_index(p);
-        return index_to_point(find(i));
-    }
-
-    void unite(Point x, Point y)
-    {
-        assert(in_bounds(x));
-        assert(in_bounds(y));
-
-        size_t ix = point_to_index(x);
-        size_t iy = point_to_index(y);
-        unite(ix, iy);
-    }
 
-private:
-    bool in_bounds(const Point& p) const
-    {
-        return p.x() >= 0
-            && p.x() < num_cols_
-            && p.y() >= 0
-            && p.y() < num_rows_;
-    }
+        int num_rows = board.num_rows();
+        num_bands = clamp<size_t>(num_bands, 1, static_cast<size_t>(max(num_rows, 1)));
 
-    size_t find(size_t i)
-    {
-        if (parent_[i] == i)
+        vector<pair<int, int>> bands;
+        for (size_t i = 0; i < num_bands; ++i)
         {
-            return i;
+            bands.emplace_back(
+                static_cast<int>(static_cast<size_t>(num_rows) * i / num_bands),
+                static_cast<int>(static_cast<size_t>(num_rows) * (i + 1) / num_bands)
+            );
         }
 
-        return parent_[i] = find(parent_[i]);
-    }
+        // Each band only touches the union-find entries of its own cells.
+        for_each(
+#if __cpp_lib_parallel_algorithm
+            execution::par,
+#endif
+            bands.begin(), bands.end(),
+            [this](pair<int, int> band) { label_rows(band.first, band.second); }
+        );
 
-    void unite(size_t x, size_t y)
-    {
-        size_t rx = find(x);
-        size_t ry = find(y);
-
-        if (rx == ry)
+        for (size_t i = 1; i < bands.size(); ++i)
         {
-            return;
-        }
-
-        if (rank_[rx] < rank_[ry])
-        {
-            swap(rx, ry);
+            int y = bands[i].first;
+            size_t ix = board_.index_of({0, y});
+            for (int x = 0; x < board.num_cols(); ++x, ++ix)
+            {
+                unite_if_same(ix, ix - static_cast<size_t>(board_.stride()));
+            }
         }
-
-        parent_[ry] = rx;
-        rank_[rx] += rank_[ry];
-    }
-
-    size_t point_to_index(Point p)
-    {
-        return static_cast<size_t>(p.y() * num_cols_) + static_cast<size_t>(p.x());
-    }
-
-    Point index_to_point(size_t i)
-    {
-        return Point{static_cast<int>(i) % num_cols_, static_cast<int>(i) / num_cols_};
-    }
-};
-
-class Region
-{
-    Point repr_;
-    char id_;
-    size_t area_;
-    size_t perimeter_;
-    size_t num_sides_;
-
-public:
-    Region(Point repr, char id, size_t area, size_t perimeter, size_t num_sides)
-        : repr_(repr), id_(id), area_(area), perimeter_(perimeter), num_sides_(num_sides)
-    {
-    }
-
-    Region(const Region&) = default;
-    Region(Region&&) noexcept = default;
-
-    char id() const
-    {
-        return id_;
     }
 
-    size_t area() const
+    uintmax_t fence_price() const
     {
-        return area_;
+        return total([this](uint32_t root) { return uintmax_t{area_[root]} * perimeter_[root]; });
     }
 
-    size_t perimeter() const
+    uintmax_t discounted_fence_price() const
     {
-        return perimeter_;
+        return total([this](uint32_t root) { return uintmax_t{area_[root]} * corners_[root]; });
     }
 
-    size_t num_sides() const
-    {
-        return num_sides_;
-    }
-};
-
-shared_ptr<Region> make_region(UnionFind& uf, const shared_ptr<const Board>& board, const set<Point>& points, char id)
-{
-    // we'll count the area, perimeter, and number of sides here in advance.
-
-    size_t area = points.size();
-
-    size_t perimeter = 0;
-    size_t sides = 0;
-    int max_x = -1;
-    int min_x = numeric_limits<int>::max();
-    int max_y = -1;
-    int min_y = numeric_limits<int>::max();
-
-    for (const auto& p : points)
+private:
+    void label_rows(int begin, int end)
     {
-        if (p.x() < min_x) min_x = p.x();
-        if (p.x() > max_x) max_x = p.x();
-        if (p.y() < min_y) min_y = p.y();
-        if (p.y() > max_y) max_y = p.y();
-
-        perimeter += 4;
-        for (const auto neighbor : board->cardinal_neighbors(p))
+        const auto stride = static_cast<size_t>(board_.stride());
+        for (int y = begin; y < end; ++y)
         {
-            if (board->at(neighbor) == id)
+            size_t ix = board_.index_of({0, y});
+            for (int x = 0; x < board_.num_cols(); ++x, ++ix)
             {
-                perimeter--;
+                char id = board_[ix];
+                bool up = board_[ix - stride] == id;
+                bool down = board_[ix + stride] == id;
+                bool left = board_[ix - 1] == id;
+                bool right = board_[ix + 1] == id;
+
+                // A corner is either convex (both sides open) or concave
+                // (both sides ours, but not the diagonal between them).
+                uint32_t corners = 0;
+                auto corner = [&](bool a, bool b, size_t diagonal) {
+                    corners += (!a && !b) || (a && b && board_[diagonal] != id);
+                };
+                corner(up, left, ix - stride - 1);
+                corner(up, right, ix - stride + 1);
+                corner(down, left, ix + stride - 1);
+                corner(down, right, ix + stride + 1);
+
+                area_[ix] = 1;
+                perimeter_[ix] = 4u - up - down - left - right;
+                corners_[ix] = corners;
+
+                if (x > 0)
+                {
+                    unite_if_same(ix, ix - 1);
+                }
+                if (y > begin)
+                {
+                    unite_if_same(ix, ix - stride);
+                }
             }
         }
     }
 
-    Point repr = uf.find(*points.begin());
-    for (int y = min_y - 1; y < max_y + 1; ++y)
+    uint32_t find(uint32_t x)
     {
-        for (int x = min_x - 1; x < max_x + 1; ++x)
+        while (parent_[x] != x)
         {
-            // check for corners
-            // corners can look like:
-            //
-            // x.    xx    .x
-            // .. or x. or x.
-            //
-            // that last configuration is actually two corners, _provided that_ two opposing corners
-            // are in-group.
-
-            size_t num_us = 0;
-
-            auto r1 = uf.find({x, y});         // upper left
-            auto r2 = uf.find({x + 1, y});     // upper right
-            auto r3 = uf.find({x, y + 1});     // lower left
-            auto r4 = uf.find({x + 1, y + 1}); // lower right
-
-            if (r1 == repr) ++num_us;
-            if (r2 == repr) ++num_us;
-            if (r3 == repr) ++num_us;
-            if (r4 == repr) ++num_us;
-
-            if (num_us == 1 || num_us == 3)
-            {
-                ++sides;
-            }
-            else if (num_us == 2 && (r1 == r4 || r2 == r3))
-            {
-                sides += 2;
-            }
+            parent_[x] = parent_[parent_[x]];
+            x = parent_[x];
         }
+        return x;
     }
 
-    return make_shared<Region>(repr, id, area, perimeter, sides);
-}
-
-vector<shared_ptr<Region>> find_regions(const shared_ptr<const Board>& board)
-{
-    UnionFind uf{board->num_rows(), board->num_cols()};
-    for (int y = 0; y < board->num_rows(); ++y)
+    void unite_if_same(size_t a, size_t b)
     {
-        for (int x = 0; x < board->num_cols(); ++x)
+        if (board_[a] != board_[b])
         {
-            Point cur{x, y};
-            Point right = cur + Dir::RIGHT;
-            Point down = cur + Dir::DOWN;
-
-            if (board->in_bounds(right) && board->at(cur) == board->at(right))
-            {
-                uf.unite(cur, right);
-            }
+            return;
+        }
 
-            if (board->in_bounds(down) && board->at(cur) == board->at(down))
-            {
-                uf.unite(cur, down);
-            }
+        uint32_t x = find(static_cast<uint32_t>(a));
+        uint32_t y = find(static_cast<uint32_t>(b));
+        if (x == y)
+        {
+            return;
         }
-    }
 
-    unordered_map<Point, set<Point>> regions_by_point;
-    for (Point p : board->all_points())
-    {
-        Point root = uf.find(p);
-        regions_by_point[root].insert(p);
+        if (area_[x] < area_[y])
+        {
+            swap(x, y);
+        }
+        parent_[y] = x;
+        area_[x] += area_[y];
+        perimeter_[x] += perimeter_[y];
+        corners_[x] += corners_[y];
     }
 
-    vector<shared_ptr<Region>> regions;
-    regions.reserve(regions_by_point.size());
-
-    for (auto& [root, points] : regions_by_point)
+    template <typename F>
+    uintmax_t total(F&& price) const
     {
-        char id = board->at(root);
-        auto region = make_region(uf, board, points, id);
-        regions.push_back(region);
+        uintmax_t sum = 0;
+        for (uint32_t i = 0; i < parent_.size(); ++i)
+        {
+            // Border cells are never labeled, so their area is zero.
+            if (parent_[i] == i && area_[i] > 0)
+            {
+                sum += price(i);
+            }
+        }
+        return sum;
     }
-
-    return regions;
-}
+};
 
 } // namespace
 
 string PartOne::solve()
 {
-    const shared_ptr<const Board> board = read_board();
-    const vector<shared_ptr<Region>> regions = find_regions(board);
-
-    auto total_price = transform_reduce(
-        regions.begin(), regions.end(),
-        static_cast<uintmax_t>(0),
-        plus<>{},
-        [](const auto& r) { return static_cast<uintmax_t>(r->area()) * r->perimeter(); }
-    );
-
-    return to_string(total_price);
+    Garden garden{*read_board(), thread::hardware_concurrency()};
+    return to_string(garden.fence_price());
 }
 
 string PartTwo::solve()
@@ -332,17 +251,8 @@ string PartTwo::solve()
     // 827988 is too high
     // next guess: 815788
 
-    auto board = read_board();
-    const vector<shared_ptr<Region>> regions = find_regions(board);
-
-    auto total_price = transform_reduce(
-        regions.begin(), regions.end(),
-        static_cast<uintmax_t>(0),
-        plus<>{},
-        [](const auto& r) { return static_cast<uintmax_t>(r->area()) * r->num_sides(); }
-    );
-
-    return to_string(total_price);
+    Garden garden{*read_board(), thread::hardware_concurrency()};
+    return to_string(garden.discounted_fence_price());
 }
 
 } // namespace day12
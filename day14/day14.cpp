@@ -4,17 +4,18 @@
 #include "point.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <ranges>
 #include <regex>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -123,6 +124,11 @@ int posmod(int a, int b)
     return (a % b + b) % b;
 }
 
+int64_t posmod(int64_t a, int64_t b)
+{
+    return (a % b + b) % b;
+}
+
 Point predict_position(const Robot& pv, const Params& params)
 {
     Point v = { pv.v.x() * params.iters, pv.v.y() * params.iters };
@@ -153,78 +159,135 @@ int quadrant_for_pos(const Point& p, const Params& params)
     return ((p.y() > params.midY) << 1) | (p.x() > params.midX);
 }
 
-size_t find_tree(Problem& problem)
+/**
+ * @brief The robots' positions and velocities along one axis, as parallel
+ *        arrays so that stepping them all is a simple vectorizable loop.
+ *
+ * Velocities are reduced mod `size`, so that positions never go negative
+ * and wrapping is one conditional subtraction.
+ */
+struct Axis
 {
-    vector<bool> grid(static_cast<size_t>(problem.params.h * problem.params.w), false);
-
-    const auto as_coord = [&](const Point& p) {
-        return static_cast<size_t>((p.y() * problem.params.w) + p.x());
-    };
+    int size;
+    vector<int> pos;
+    vector<int> vel;
 
-    const auto print = [&]() {
-        for (auto y = 0; y < problem.params.h; ++y) {
-            for (auto x = 0; x < problem.params.w; ++x) {
-                size_t coord = as_coord({x, y});
-                dbg() << (grid[coord] ? '#' : '.');
-            }
-            dbg() << '\n';
+    Axis(int size, const vector<Robot>& robots, int (Point::*coord)() const)
+        : size(size)
+    {
+        pos.reserve(robots.size());
+        vel.reserve(robots.size());
+        for (const auto& robot : robots)
+        {
+            pos.push_back(posmod((robot.p.*coord)(), size));
+            vel.push_back(posmod((robot.v.*coord)(), size));
         }
-        dbg() << endl;
-    };
-
-    const auto find_filled_block = [&](const Point& p) {
-        // find a 5x5 block that's all filled; it's likely
-        // that finding such a block means we've found the
-        // tree.
+    }
 
-        int min_x = p.x() - 2;
-        int min_y = p.y() - 2;
-        int max_x = p.x() + 2;
-        int max_y = p.y() + 2;
+    void step()
+    {
+        for (size_t i = 0; i < pos.size(); ++i)
+        {
+            int next = pos[i] + vel[i];
+            pos[i] = next - (next >= size ? size : 0);
+        }
+    }
 
-        if (min_x < 0 || min_y < 0 || max_x >= problem.params.w || max_y >= problem.params.h)
+    // n^2 times the variance of the positions, which is exact in integers.
+    int64_t scaled_variance() const
+    {
+        int64_t sum = 0;
+        int64_t sum_sq = 0;
+        for (int x : pos)
         {
-            return false;
+            sum += x;
+            sum_sq += static_cast<int64_t>(x) * x;
         }
+        return static_cast<int64_t>(pos.size()) * sum_sq - sum * sum;
+    }
 
-        for (int y = min_y; y <= max_y; ++y)
+    /**
+     * @brief Returns the step in [0, size) at which the robots are most
+     *        tightly bunched along this axis.
+     *
+     * Positions along an axis repeat every `size` steps, so one period
+     * covers every possibility.
+     */
+    int most_clustered_step()
+    {
+        int best_step = 0;
+        int64_t best_variance = numeric_limits<int64_t>::max();
+        for (int t = 0; t < size; ++t)
         {
-            for (int x = min_x; x <= max_x; ++x)
+            if (auto v = scaled_variance(); v < best_variance)
             {
-                if (!grid[as_coord({x, y})])
-                {
-                    return false;
-                }
+                best_step = t;
+                best_variance = v;
             }
+            step();
         }
+        return best_step;
+    }
+};
 
-        return true;
-    };
+// Returns x such that a * x == 1 (mod m), for coprime a and m.
+int64_t mod_inverse(int64_t a, int64_t m)
+{
+    int64_t old_r = a, r = m;
+    int64_t old_s = 1, s = 0;
+    while (r != 0)
+    {
+        int64_t q = old_r / r;
+        old_r = exchange(r, old_r - q * r);
+        old_s = exchange(s, old_s - q * s);
+    }
 
-    for (size_t iters = 1; iters < 100000000000; ++iters)
+    if (old_r != 1)
     {
-        fill_n(grid.begin(), grid.size(), false);
+        throw invalid_argument{"moduli are not coprime"};
+    }
+    return posmod(old_s, m);
+}
 
-        for (auto& robot : problem.robots)
+size_t find_tree(const Problem& problem)
+{
+    // The tree shows up when the robots are bunched together on both axes
+    // at once.  Each axis is periodic on its own, so find the most
+    // clustered step for each, then combine them with the Chinese
+    // Remainder Theorem: t == tx (mod w) and t == ty (mod h).
+    const auto& params = problem.params;
+    Axis xs{params.w, problem.robots, &Point::x};
+    Axis ys{params.h, problem.robots, &Point::y};
+
+    int64_t tx = xs.most_clustered_step();
+    int64_t ty = ys.most_clustered_step();
+    int64_t w = params.w;
+    int64_t h = params.h;
+
+    int64_t k = posmod((ty - tx) * mod_inverse(w % h, h), h);
+    int64_t t = tx + w * k;
+
+    if (g_verbose >= static_cast<int>(LogLevel::INFO))
+    {
+        vector<bool> grid(static_cast<size_t>(params.h * params.w), false);
+        Params at_t = params;
+        at_t.iters = static_cast<int>(t);
+        for (const auto& robot : problem.robots)
         {
-            robot.p = predict_position(robot, problem.params);
-            grid[as_coord(robot.p)] = true;
+            Point p = predict_position(robot, at_t);
+            grid[static_cast<size_t>(p.y() * params.w + p.x())] = true;
         }
 
-        for (const auto& robot : problem.robots)
-        {
-            if (find_filled_block(robot.p))
-            {
-                // Maybe?
-                print();
-                return iters;
+        for (auto y = 0; y < params.h; ++y) {
+            for (auto x = 0; x < params.w; ++x) {
+                dbg() << (grid[static_cast<size_t>(y * params.w + x)] ? '#' : '.');
             }
+            dbg() << '\n';
         }
+        dbg() << endl;
     }
 
-    dbg(LogLevel::ERROR) << "No tree candidate position found" << endl;
-
-    return 0;
+    return static_cast<size_t>(t);
 }
 
 } // namespace
@@ -256,8 +319,6 @@ string PartOne::solve()
 string PartTwo::solve()
 {
     auto problem = read_input();
-    problem.params.iters = 1; // gotta step one by one; 1000 at a time only works for part 1
-
     return to_string(find_tree(problem));
 }
 
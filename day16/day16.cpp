@@ -1,21 +1,20 @@
 #include "day16.h"
 
 #include "board.h"
+#include "graph_search.h"
+#include "input_cache.h"
 #include "point.h"
-#include "turtle.h"
 
 #include <algorithm>
-#include <deque>
+#include <array>
 #include <exception>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <numeric>
-#include <queue>
 #include <ranges>
 #include <sstream>
 #include <string>
-#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -81,42 +80,36 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-Board read_board()
+shared_ptr<const Board> read_board()
 {
-    auto input = get_input();
+    return input_cache::get(kInputFile, [] {
+        auto input = get_input();
 
-    Board b;
+        Board b;
 
-    *input >> b;
+        *input >> b;
 
-    return b;
+        return b;
+    });
 }
 
-struct Edge
-{
-    Point from;
-    Point to;
-    Point dir;
-    int length;
-};
-
 class Graph
 {
+    // Each search state is a cell of the (padded) board and a facing,
+    // numbered cell * 4 + facing, with facings in Dir::CARDINALS order.
+    static constexpr search::Weight kTurnCost = 1000;
+
+    Board board;
     Point start;
     Point end;
-    unordered_map<Point, vector<Edge>> edges;
-    Board board;
-
-    unordered_map<Turtle, size_t> dist;
-    unordered_map<Turtle, vector<Turtle>> prev;
-    Turtle end_turtle;
+    search::ShortestPaths paths;
 
 public:
-    Graph(const Board& board)
-        : start()
+    Graph(const Board& unpadded)
+        : board(unpadded.with_border(1, '#'))
+        , start()
         , end()
-        , edges()
-        , board(board)
+        , paths(0, search::Predecessors::ONE)
     {
         for (auto p : board.all_points())
         {
@@ -130,52 +123,30 @@ public:
             }
         }
 
-        auto can_move_to_side = [&board](Point p, Point d) {
-            Point left = p + Dir::turn_left(d);
-            Point right = p + Dir::turn_right(d);
-
-            return (board.in_bounds(left) && board[left] != '#') || (board.in_bounds(right) && board[right] != '#');
-        };
-
-        auto can_go_straight = [&board](Point p, Point d) {
-            Point next = p + d;
-            return board.in_bounds(next) && board[next] != '#';
+        const array<size_t, 4> step = {
+            static_cast<size_t>(-board.stride()), // UP
+            1,                                    // RIGHT
+            static_cast<size_t>(board.stride()),  // DOWN
+            static_cast<size_t>(-1),              // LEFT
         };
 
-        // BFS to build the graph
-        deque<Point> q{start};
-        unordered_set<Point> visited;
-        while (!q.empty())
-        {
-            Point cur = q.front();
-            q.pop_front();
+        auto neighbors = [&](search::Node state, auto&& emit) {
+            size_t cell = state / 4;
+            size_t facing = state % 4;
 
-            if (const auto [_, inserted] = visited.insert(cur); !inserted)
+            size_t ahead = cell + step[facing];
+            if (board[ahead] != '#')
             {
-                continue;
+                emit(static_cast<search::Node>(ahead * 4 + facing), 1);
             }
 
-            for (const auto& d : Dir::CARDINALS)
-            {
-                auto n = cur + d;
-                if (!board.in_bounds(n) || board[n] == '#')
-                {
-                    continue;
-                }
-
-                int weight = 1;
-
-                Point new_p = n;
-                while (can_go_straight(new_p, d) && !can_move_to_side(new_p, d))
-                {
-                    weight++;
-                    new_p += d;
-                }
-
-                edges[cur].push_back(Edge{cur, new_p, d, weight});
-                q.push_back(new_p);
-            }
-        }
+            emit(static_cast<search::Node>(cell * 4 + (facing + 1) % 4), kTurnCost);
+            emit(static_cast<search::Node>(cell * 4 + (facing + 3) % 4), kTurnCost);
+        };
+
+        // Reindeer start out facing east.
+        auto source = static_cast<search::Node>(board.index_of(start) * 4 + 1);
+        paths = search::dijkstra(board.buffer_size() * 4, source, kTurnCost, neighbors, search::Predecessors::ALL);
     }
 
     void draw(ostream& out, const unordered_set<Point>& path)
@@ -198,150 +169,66 @@ public:
         }
     }
 
-    pair<size_t, vector<Edge>> find_shortest_path()
+    pair<size_t, vector<Point>> find_shortest_path() const
     {
-        dijkstra();
+        auto ends = end_states();
 
-        vector<Edge> path;
-        Turtle to = end_turtle;
-        while (to.position() != start)
+        vector<Point> path;
+        for (auto state : paths.path_to(ends.front()))
         {
-            Turtle from = prev[to].front(); // just pick any old turtle, they're all the same cost
-            for (const auto& edge : edges.at(from.position()))
+            Point p = board.point_of(state / 4);
+            if (path.empty() || path.back() != p)
             {
-                if (edge.to == to.position())
-                {
-                    path.push_back(edge);
-                    to = from;
-                    break;
-                }
+                path.push_back(p);
             }
         }
 
-        reverse(path.begin(), path.end());
-
-        for (const auto& edge : path)
-        {
-            dbg() << edge.from << " -> " << edge.to << " (" << dist[{edge.to, edge.dir}] << ")" << endl;
-        }
-
-        return {dist[end_turtle], path};
+        return {paths.distance(ends.front()), path};
     }
 
-    pair<size_t, unordered_set<Point>> find_all_shortest_path_points()
+    pair<size_t, unordered_set<Point>> find_all_shortest_path_points() const
     {
-        dijkstra();
+        auto ends = end_states();
+        auto marked = paths.on_shortest_paths(ends);
 
         unordered_set<Point> result;
-        deque<Turtle> q{end_turtle};
-
-        vector<pair<Point, Point>> found_edges;
-        while (!q.empty())
+        for (size_t state = 0; state < marked.size(); ++state)
         {
-            Turtle cur = q.front();
-            q.pop_front();
-
-            result.insert(cur.position());
-            for (auto& t : prev[cur])
+            if (marked[state])
             {
-                found_edges.push_back({cur.position(), t.position()});
-                q.push_back(t);
+                result.insert(board.point_of(state / 4));
             }
         }
 
-        for (const auto& [lhs, rhs] : found_edges)
-        {
-            Point dir{clamp(rhs.x() - lhs.x(), -1, 1), clamp(rhs.y() - lhs.y(), -1, 1)};
-
-            Point p = lhs;
-            do
-            {
-                result.insert(p);
-                p += dir;
-            } while (p != rhs);
-        }
-
-        return {dist[end_turtle], result};
+        return {paths.distance(ends.front()), result};
     }
 
 private:
-    Turtle dijkstra()
+    // All of the cheapest ways to arrive at the end, whichever way we face.
+    vector<search::Node> end_states() const
     {
-        if (dist.size() > 0)
-        {
-            return end_turtle;
-        }
-
-        // pq is a min-queue - smallest element first.
-        // pairs compare lexicographically, so weight comes first.
-        priority_queue<pair<size_t, Turtle>, vector<pair<size_t, Turtle>>, greater<>> pq;
+        auto first = static_cast<search::Node>(board.index_of(end) * 4);
 
-        dist.reserve(edges.size() * 4);
-        for (const auto& [p, _] : edges)
+        search::Weight cost = search::kUnreachable;
+        for (search::Node state = first; state < first + 4; ++state)
         {
-            for (const auto& d : Dir::CARDINALS)
-            {
-                dist[{p, d}] = numeric_limits<size_t>::max();
-            }
+            cost = min(cost, paths.distance(state));
         }
 
-        pq.push({0, {start, Dir::RIGHT}});
-        dist[{start, Dir::RIGHT}] = 0;
-
-        while (!pq.empty())
+        if (cost == search::kUnreachable)
         {
-            auto [w, p] = pq.top();
-            pq.pop();
-
-            for (const auto& edge : edges.at(p.position()))
-            {
-                int turns = 0;
-                bool dx = p.direction().x() != edge.dir.x();
-                bool dy = p.direction().y() != edge.dir.y();
-                if (dx && dy)
-                {
-                    turns = 1;
-                }
-                else if (dx || dy)
-                {
-                    turns = 2;
-                }
-
-                size_t alt = dist[p] + edge.length + (turns * 1000);
-                if (alt == dist[{edge.to, edge.dir}])
-                {
-                    prev[{edge.to, edge.dir}].push_back(p);
-                }
-                else if (alt < dist[{edge.to, edge.dir}])
-                {
-                    dist[{edge.to, edge.dir}] = alt;
-                    prev[{edge.to, edge.dir}] = {p};
-                    pq.push({alt, {edge.to, edge.dir}});
-                }
-            }
+            throw logic_error{"no path found"};
         }
 
-        size_t cost = numeric_limits<size_t>::max();
-        for (const auto& [d, c] : dist)
+        vector<search::Node> ends;
+        for (search::Node state = first; state < first + 4; ++state)
         {
-            if (d.position() != end)
-            {
-                continue;
-            }
-
-            if (c < cost)
+            if (paths.distance(state) == cost)
             {
-                end_turtle = d;
-                cost = c;
+                ends.push_back(state);
             }
         }
-
-        if (cost == numeric_limits<size_t>::max())
-        {
-            throw logic_error{"no path found"};
-        }
-
-        return end_turtle;
+        return ends;
     }
 };
 
@@ -350,16 +237,11 @@ private:
 string PartOne::solve()
 {
     auto board = read_board();
-    Graph graph(board);
+    Graph graph(*board);
 
     auto dij = graph.find_shortest_path();
 
-    unordered_set<Point> path;
-    for (auto edge : dij.second)
-    {
-        path.insert(edge.from);
-        path.insert(edge.to);
-    }
+    unordered_set<Point> path{dij.second.begin(), dij.second.end()};
 
     graph.draw(dbg(), path);
     dbg() << "path has " << path.size() << " points" << endl;
@@ -370,7 +252,7 @@ string PartOne::solve()
 string PartTwo::solve()
 {
     auto board = read_board();
-    Graph graph(board);
+    Graph graph(*board);
 
     auto [cost, points] = graph.find_all_shortest_path_points();
 
@@ -1,18 +1,16 @@
 #include "day17.h"
 
 #include <algorithm>
-#include <cmath>
+#include <array>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iostream>
 #include <memory>
-#include <numeric>
-#include <ranges>
-#include <set>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -42,7 +40,7 @@ Register C: 0
 
 Program: 0,3,5,4,3,0)";
 
-enum Opcode
+enum Opcode : uint8_t
 {
     kOpcodeAdv = 0,
     kOpcodeBxl = 1,
@@ -52,39 +50,55 @@ enum Opcode
     kOpcodeOut = 5,
     kOpcodeBdv = 6,
     kOpcodeCdv = 7,
+
+    // Not a real opcode; marks a position that would fault if executed.
+    kOpcodeInvalid = 8,
+};
+
+// Combo operands 0-3 are literals and 4-6 name registers, so keeping the
+// literals in the register file lets every combo operand be a plain index.
+enum Register : uint8_t
+{
+    kRegA = 4,
+    kRegB = 5,
+    kRegC = 6,
+    kNumRegs = 7,
 };
 
+struct Instruction
+{
+    Opcode op;
+    uint8_t operand;
+};
+
+using Registers = array<int64_t, kNumRegs>;
+
+int64_t shift_right(int64_t value, int64_t amount)
+{
+    return amount >= 64 ? 0 : value >> amount;
+}
+
 class Computer
 {
     int64_t a_, b_, c_;
     vector<int> instructions_;
-    ostream& console_;
-    size_t ip_;
-    bool needs_comma_;
+
+    // One decoded instruction per position, not per pair, so jumps to odd
+    // addresses behave just as they would on the raw program.
+    vector<Instruction> code_;
 
     friend ostream& operator<<(ostream& os, const Computer& computer);
 
 public:
-    Computer(int64_t a, int64_t b, int64_t c, vector<int> instructions, ostream& console)
+    Computer(int64_t a, int64_t b, int64_t c, vector<int> instructions)
         : a_(a)
         , b_(b)
         , c_(c)
-        , instructions_(instructions)
-        , console_(console)
-        , ip_(0)
-        , needs_comma_(false)
+        , instructions_(std::move(instructions))
+        , code_(decode(instructions_))
     {
     }
 
-    void reset()
-    {
-        a_ = 0;
-        b_ = 0;
-        c_ = 0;
-        ip_ = 0;
-        needs_comma_ = false;
-    }
-
     int64_t a() const
     {
         return a_;
@@ -100,11 +114,6 @@ public:
         return c_;
     }
 
-    size_t ip() const
-    {
-        return ip_;
-    }
-
     const vector<int>& instructions() const
     {
         return instructions_;
@@ -115,178 +124,289 @@ public:
         this->a_ = a;
     }
 
-    void set_b(int64_t b)
-    {
-        this->b_ = b;
-    }
-
-    void set_c(int64_t c)
-    {
-        this->c_ = c;
-    }
-
-    void run()
-    {
-        //size_t ip = 0;
+    vector<int> run() const
+    {
+        vector<int> output;
+        Registers regs = initial_registers(a_);
+        execute(regs, 0, [&output](int value) {
+            output.push_back(value);
+            return true;
+        });
+        return output;
+    }
+
+    /**
+     * @brief Runs the program once for each starting value of register A,
+     *        stopping at each run's first `out`.
+     *
+     * Runs are executed in lock-step batches, so each instruction is
+     * dispatched once per batch rather than once per run.  A batch only
+     * falls back to running its lanes one at a time if a `jnz` sends them
+     * different ways.
+     *
+     * @param as       starting values for register A.
+     * @param outputs  receives each run's first output, or -1 if it halted
+     *                 without printing anything.
+     */
+    void first_outputs(span<const int64_t> as, span<int> outputs) const
+    {
+        constexpr size_t kLanes = 64;
+
+        array<array<int64_t, kLanes>, kNumRegs> regs;
+        for (uint8_t r = 0; r < kRegA; ++r)
+        {
+            regs[r].fill(r);
+        }
 
-        while (ip_ < instructions_.size())
+        for (size_t base = 0; base < as.size(); base += kLanes)
         {
-            dbg(LogLevel::DEBUG) << "IP: " << ip_ << ", op=" << instructions_[ip_] << endl;
-            switch (instructions_[ip_])
+            const size_t n = min(kLanes, as.size() - base);
+            copy_n(as.begin() + static_cast<ptrdiff_t>(base), n, regs[kRegA].begin());
+            fill_n(regs[kRegB].begin(), n, b_);
+            fill_n(regs[kRegC].begin(), n, c_);
+
+            auto& a = regs[kRegA];
+            auto& b = regs[kRegB];
+            auto& c = regs[kRegC];
+            auto out = outputs.subspan(base, n);
+            fill(out.begin(), out.end(), -1);
+
+            size_t ip = 0;
+            while (ip < code_.size())
             {
-            case kOpcodeAdv: adv(ip_); break;
-            case kOpcodeBxl: bxl(ip_); break;
-            case kOpcodeBst: bst(ip_); break;
-            case kOpcodeJnz: jnz(ip_); break;
-            case kOpcodeBxc: bxc(ip_); break;
-            case kOpcodeOut: out(ip_); break;
-            case kOpcodeBdv: bdv(ip_); break;
-            case kOpcodeCdv: cdv(ip_); break;
-            default:
-                throw runtime_error("Invalid opcode");
+                const auto [op, x] = code_[ip];
+                // Only meaningful for ops that take a combo operand; the
+                // literal operand of bxl, jnz and bxc can be 7, one past
+                // the register file.
+                auto combo = [&regs, x = x](size_t i) { return regs[x][i]; };
+                switch (op)
+                {
+                case kOpcodeAdv:
+                    for (size_t i = 0; i < n; ++i) a[i] = shift_right(a[i], combo(i));
+                    break;
+                case kOpcodeBxl:
+                    for (size_t i = 0; i < n; ++i) b[i] ^= x;
+                    break;
+                case kOpcodeBst:
+                    for (size_t i = 0; i < n; ++i) b[i] = combo(i) & 0x7;
+                    break;
+                case kOpcodeJnz:
+                {
+                    size_t taken = static_cast<size_t>(count_if(a.begin(), a.begin() + static_cast<ptrdiff_t>(n), [](int64_t v) { return v != 0; }));
+                    if (taken != 0 && taken != n)
+                    {
+                        diverge(regs, n, ip, out);
+                        ip = code_.size();
+                        continue;
+                    }
+                    if (taken != 0)
+                    {
+                        ip = x;
+                        continue;
+                    }
+                    break;
+                }
+                case kOpcodeBxc:
+                    for (size_t i = 0; i < n; ++i) b[i] ^= c[i];
+                    break;
+                case kOpcodeOut:
+                    for (size_t i = 0; i < n; ++i) out[i] = static_cast<int>(combo(i) & 0x7);
+                    ip = code_.size();
+                    continue;
+                case kOpcodeBdv:
+                    for (size_t i = 0; i < n; ++i) b[i] = shift_right(a[i], combo(i));
+                    break;
+                case kOpcodeCdv:
+                    for (size_t i = 0; i < n; ++i) c[i] = shift_right(a[i], combo(i));
+                    break;
+                default:
+                    throw runtime_error("Invalid operand");
+                }
+                ip += 2;
             }
         }
     }
 
-    /*
-    2,4
-    1,6
-    7,5
-    4,4
-    1,7
-    0,3
-    5,5
-    3,0
-
-    bst 4     ; bst %a
-    bxl 6     ; bxl 6
-    cdv 5     ; cdv %b
-    bxc 4     ; bxc _
-    bxl 7     ; bxl 7
-    adv 3     ; adv 3
-    out 5     ; out %b
-    jnz 0     ; jnz 0
-
-    void loop()
-    {
-        // b = (a & 0x7) ^ 6
-        // b = (((a & 0x7) ^ 6) ^ (a >> ((a & 0x7) ^ 6))) ^ 7
-        do
-        {
-            b = a & 0b111;
-            b = b ^ 6;  // b ^ 0b110
-            c = a / pow(2, b);
-            b = b ^ c;
-            b = b ^ 7;
-            a = a / 8;
-            cout << b;
-
-        } while (a != 0);
-    }
-
-    */
-
 private:
-    void adv(size_t& ip)
+    static vector<Instruction> decode(const vector<int>& instructions)
     {
-        ip++;
-        a_ = a_ >> get_combo(ip++);
-    }
+        vector<Instruction> code;
+        for (size_t ip = 0; ip + 1 < instructions.size(); ++ip)
+        {
+            int op = instructions[ip];
+            int operand = instructions[ip + 1];
+            if (op < 0 || op > 7 || operand < 0 || operand > 7)
+            {
+                throw runtime_error("Invalid instruction");
+            }
 
-    void bxl(size_t& ip)
-    {
-        ip++;
-        b_ ^= get_literal(ip++);
+            bool uses_combo = op != kOpcodeBxl && op != kOpcodeJnz && op != kOpcodeBxc;
+            if (uses_combo && operand == 7)
+            {
+                code.push_back({kOpcodeInvalid, 0});
+            }
+            else
+            {
+                code.push_back({static_cast<Opcode>(op), static_cast<uint8_t>(operand)});
+            }
+        }
+        return code;
     }
 
-    void bst(size_t& ip)
+    Registers initial_registers(int64_t a) const
     {
-        ip++;
-        auto operand = get_combo(ip++);
-        b_ = (operand & 0x7); // keep the lowest three bits
+        return {0, 1, 2, 3, a, b_, c_};
     }
 
-    void jnz(size_t& ip)
+    /**
+     * @brief Runs from `ip` until the program halts or `emit` returns false.
+     */
+    template <typename Emit>
+    void execute(Registers& r, size_t ip, Emit&& emit) const
     {
-        if (a_ == 0)
+        while (ip < code_.size())
         {
+            const auto [op, x] = code_[ip];
+            switch (op)
+            {
+            case kOpcodeAdv: r[kRegA] = shift_right(r[kRegA], r[x]); break;
+            case kOpcodeBxl: r[kRegB] ^= x; break;
+            case kOpcodeBst: r[kRegB] = r[x] & 0x7; break;
+            case kOpcodeJnz:
+                if (r[kRegA] != 0)
+                {
+                    ip = x;
+                    continue;
+                }
+                break;
+            case kOpcodeBxc: r[kRegB] ^= r[kRegC]; break;
+            case kOpcodeOut:
+                if (!emit(static_cast<int>(r[x] & 0x7)))
+                {
+                    return;
+                }
+                break;
+            case kOpcodeBdv: r[kRegB] = shift_right(r[kRegA], r[x]); break;
+            case kOpcodeCdv: r[kRegC] = shift_right(r[kRegA], r[x]); break;
+            default:
+                throw runtime_error("Invalid operand");
+            }
             ip += 2;
         }
-        else
-        {
-            ip = static_cast<size_t>(get_literal(ip + 1));
-        }
     }
 
-    void bxc(size_t& ip)
+    template <typename Lanes>
+    void diverge(const Lanes& regs, size_t n, size_t ip, span<int> out) const
     {
-        ip += 2; // ignores operand
-        b_ ^= c_;
+        for (size_t i = 0; i < n; ++i)
+        {
+            Registers r = initial_registers(regs[kRegA][i]);
+            r[kRegB] = regs[kRegB][i];
+            r[kRegC] = regs[kRegC][i];
+            execute(r, ip, [&](int value) {
+                out[i] = value;
+                return false;
+            });
+        }
     }
+};
 
-    void out(size_t& ip)
+ostream& operator<<(ostream& os, const Computer& computer)
+{
+    os << "Register A: " << computer.a() << endl;
+    os << "Register B: " << computer.b() << endl;
+    os << "Register C: " << computer.c() << endl;
+    os << "Instructions: ";
+    for (size_t i = 0; i < computer.instructions().size(); i++)
     {
-        ip++;
-        if (needs_comma_)
+        if (i > 0)
         {
-            console_ << ',';
+            os << ", ";
         }
-        needs_comma_ = true;
-
-        console_ << (get_combo(ip++) & 0x7); // combo operand, modulo 8
+        os << computer.instructions()[i];
     }
+    os << endl;
 
-    void bdv(size_t& ip)
-    {
-        ip++;
-        b_ = a_ >> get_combo(ip++);
-    }
+    return os;
+}
 
-    void cdv(size_t& ip)
+string join(const vector<int>& output)
+{
+    stringstream ss;
+    for (size_t i = 0; i < output.size(); ++i)
     {
-        ip++;
-        c_ = a_ >> get_combo(ip++);
+        if (i > 0)
+        {
+            ss << ',';
+        }
+        ss << output[i];
     }
+    return ss.str();
+}
 
-    int64_t get_literal(size_t operand_index)
+/**
+ * @brief Finds the smallest starting value of register A for which the
+ *        program prints a copy of itself.
+ *
+ * Puzzle programs are a single loop that prints one value per pass and
+ * then shifts A right by three bits, so the last value printed depends
+ * only on A's top three bits, the one before it on the top six, and so on.
+ * That lets us build A three bits at a time from the end of the program:
+ * each surviving prefix is extended by all eight possible next digits, and
+ * one pass of the real program over each extension says whether it prints
+ * the right value.  Every level's extensions run as one batch.
+ *
+ * Nothing here depends on what the loop computes, only on its shape; the
+ * finalists are run in full to make sure that shape held.
+ */
+optional<int64_t> find_quine(Computer& computer)
+{
+    const auto& program = computer.instructions();
+    if (program.size() * 3 > 63)
     {
-        return static_cast<int64_t>(instructions_[operand_index]);
+        throw runtime_error("Program too long to search");
     }
 
-    int64_t get_combo(size_t operand_index)
+    vector<int64_t> prefixes{0};
+    vector<int64_t> candidates;
+    vector<int> outputs;
+    for (auto it = program.rbegin(); it != program.rend(); ++it)
     {
-        switch (instructions_[operand_index] % 8)
+        candidates.clear();
+        for (int64_t prefix : prefixes)
+        {
+            for (int64_t digit = 0; digit < 8; ++digit)
+            {
+                candidates.push_back((prefix << 3) | digit);
+            }
+        }
+
+        outputs.resize(candidates.size());
+        computer.first_outputs(candidates, outputs);
+
+        prefixes.clear();
+        for (size_t i = 0; i < candidates.size(); ++i)
         {
-        case 0: return 0;
-        case 1: return 1;
-        case 2: return 2;
-        case 3: return 3;
-        case 4: return a_;
-        case 5: return b_;
-        case 6: return c_;
-        case 7: // fallthrough
-        default: throw runtime_error("Invalid operand");
+            if (outputs[i] == *it)
+            {
+                prefixes.push_back(candidates[i]);
+            }
         }
+
+        dbg(LogLevel::DEBUG) << "next=" << *it << "; " << prefixes.size() << " candidates" << endl;
     }
-};
 
-ostream& operator<<(ostream& os, const Computer& computer)
-{
-    os << "Register A: " << computer.a() << endl;
-    os << "Register B: " << computer.b() << endl;
-    os << "Register C: " << computer.c() << endl;
-    os << "Instructions: ";
-    for (size_t i = 0; i < computer.instructions().size(); i++)
+    // Extensions are generated in increasing order, so the first finalist
+    // that checks out is the smallest.
+    for (int64_t a : prefixes)
     {
-        if (i > 0)
+        computer.set_a(a);
+        if (computer.run() == program)
         {
-            os << ", ";
+            return a;
         }
-        os << computer.instructions()[i];
     }
-    os << endl;
-
-    return os;
+    return nullopt;
 }
 
 [[maybe_unused]]
@@ -300,7 +420,7 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-Computer read_input(ostream& console)
+Computer read_input()
 {
     auto in = get_input();
     *in >> ws;
@@ -368,7 +488,7 @@ Computer read_input(ostream& console)
         instructions.push_back(stoi(tok));
     }
 
-    auto comp = Computer(a, b, c, instructions, console);
+    auto comp = Computer(a, b, c, std::move(instructions));
     dbg(LogLevel::DEBUG) << comp << endl;
     return comp;
 }
@@ -377,82 +497,23 @@ Computer read_input(ostream& console)
 
 string PartOne::solve()
 {
-    stringstream ss;
-    Computer computer = read_input(ss);
-    computer.run();
-    return ss.str();
+    Computer computer = read_input();
+    return join(computer.run());
 }
 
 string PartTwo::solve()
 {
-    stringstream ss;
-    Computer computer = read_input(ss);
-
-    auto instructions = computer.instructions();
-    set<int64_t> candidates{0};
-
-    // from analyzing the input instruction, each loop's output depends only
-    // on the value of the 'a' register - 'b' and 'c' are exclusively derived
-    // from it.  further, the only modification to 'a' is an unconditional
-    // right shift by 3 bits.
-    //
-    // We can inductively solve this, but this solution will only work for
-    // my own test input.  I've got no Earthly idea how to solve this generally.
-    //
-    // The solution starts by finding values of a that produce the last output
-    // number.  Then for each candidate, shift it left three bits, and for each
-    // of the 8 possible values, check if it produces the next output number.
-    // so on, so forth.
-    for (auto it = instructions.rbegin(); it != instructions.rend(); ++it)
-    {
-        dbg() << "next=" << *it << "; candidates: ";
-        for (const int64_t& candidate : candidates)
-        {
-            dbg() << candidate << ' ';
-        }
-        dbg() << endl;
-
-        int64_t out = *it;
-        vector<int64_t> tmp;
-        for (const int64_t& candidate : candidates)
-        {
-            int64_t maybe = candidate << 3;
-            for (auto i = 0; i < 8; ++i)
-            {
-                auto a = maybe + i;
-
-                // This is the part that's specific to my input.
-                // Algebra FTW!
-                auto b = (a & 0x7) ^ 6;
-                b = ((b ^ (a >> b)) ^ 7) & 0x7;
-
-                if (b == out)
-                {
-                    tmp.push_back(a);
-                }
-            }
-        }
-
-        candidates.clear();
-        candidates.insert(tmp.begin(), tmp.end());
-    }
-
-    if (candidates.empty())
+    Computer computer = read_input();
+    auto a = find_quine(computer);
+    if (!a)
     {
         return "no answer";
     }
 
-    auto min_candidate = *candidates.begin();
-
-    ss.str("");
-    ss.clear();
-    computer.reset();
-    computer.set_a(min_candidate);
-    computer.run();
-
-    dbg() << "min_candidate=" << min_candidate << "; output=" << ss.str() << endl;
+    computer.set_a(*a);
+    dbg() << "min_candidate=" << *a << "; output=" << join(computer.run()) << endl;
 
-    return to_string(*candidates.begin());
+    return to_string(*a);
 }
 
 } // namespace day17
@@ -1,24 +1,23 @@
 #include "day18.h"
 
 #include "board.h"
+#include "graph_search.h"
 #include "parsers.h"
 #include "point.h"
 
 #include <algorithm>
-#include <deque>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <optional>
-#include <queue>
 #include <ranges>
 #include <regex>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -94,57 +93,28 @@ const Params get_params()
     return g_test_input ? kTestParams : kRealParams;
 }
 
-vector<Point> dijkstra(const Board& board, Point start, Point end)
+vector<Point> shortest_path(const Board& board, Point start, Point end)
 {
-    unordered_map<Point, size_t> dist;
-    unordered_map<Point, Point> prev;
-
-    // pq is a min-queue - smallest element first.
-    // pairs compare lexicographically, so weight comes first.
-    priority_queue<pair<size_t, Point>, vector<pair<size_t, Point>>, greater<>> pq;
-
-
-    dist.reserve(board.num_rows() * board.num_cols());
-    for (auto p : board.all_points())
+    Board padded = board.with_border(1, '#');
+    auto paths = search::dijkstra(
+        padded.buffer_size(),
+        static_cast<search::Node>(padded.index_of(start)),
+        1,
+        search::cardinal_moves(padded, [](char c) { return c != '#'; })
+    );
+
+    auto cells = paths.path_to(static_cast<search::Node>(padded.index_of(end)));
+    if (cells.empty())
     {
-        dist[p] = numeric_limits<size_t>::max();
+        throw logic_error{"no path found"};
     }
 
-    pq.push({0, start});
-    dist[start] = 0;
-
-    while (!pq.empty())
+    vector<Point> path;
+    path.reserve(cells.size());
+    for (auto cell : cells)
     {
-        auto [w, p] = pq.top();
-        pq.pop();
-
-        for (const auto& n : board.cardinal_neighbors(p))
-        {
-            if (board[n] == '#')
-            {
-                continue;
-            }
-
-            size_t alt = dist[p] + 1;
-            if (alt < dist[n])
-            {
-                dist[n] = alt;
-                prev[n] = p;
-                pq.push({alt, n});
-            }
-        }
+        path.push_back(padded.point_of(cell));
     }
-
-    vector<Point> path{end};
-    Point cur = end;
-    do
-    {
-        cur = prev[cur];
-        path.push_back(cur);
-    } while (cur != start);
-
-    reverse(path.begin(), path.end());
-
     return path;
 }
 
@@ -181,38 +151,132 @@ Puzzle read_input(const Params& params)
     return Puzzle{params, points_vec, board};
 }
 
-bool is_reachable(const Board& board, const Point& start, const Point& end)
+// Union-find over flat cell indices.  find() halves paths iteratively, so
+// there's no recursion to overflow on very large grids.
+class DisjointSets
 {
-    unordered_set<Point> visited;
-    deque<Point> q{start};
+    vector<uint32_t> parent_;
+    vector<uint32_t> size_;
 
-    while (!q.empty())
+public:
+    explicit DisjointSets(size_t n)
+        : parent_(n)
+        , size_(n, 1)
     {
-        auto p = q.front();
-        q.pop_front();
+        iota(parent_.begin(), parent_.end(), 0);
+    }
 
-        if (p == end)
+    uint32_t find(uint32_t x)
+    {
+        while (parent_[x] != x)
         {
-            return true;
+            parent_[x] = parent_[parent_[x]];
+            x = parent_[x];
         }
+        return x;
+    }
 
-        if (auto [_, inserted] = visited.insert(p); !inserted)
+    void unite(uint32_t x, uint32_t y)
+    {
+        x = find(x);
+        y = find(y);
+        if (x == y)
         {
-            continue;
+            return;
+        }
+
+        if (size_[x] < size_[y])
+        {
+            swap(x, y);
+        }
+        parent_[y] = x;
+        size_[x] += size_[y];
+    }
+};
+
+/**
+ * @brief Returns the index of the first block in `blocks` that cuts `start`
+ *        off from `end`, or nullopt if they stay connected.
+ *
+ * Rather than searching once per dropped block, this drops every block up
+ * front and then lifts them in reverse order, merging each reopened cell
+ * with its open neighbors.  The block whose removal first reconnects start
+ * and end is the one that disconnected them, so the whole sequence costs
+ * near-linear time in the number of cells plus blocks.
+ *
+ * Blocks before `first` are assumed never to disconnect the two points.
+ */
+optional<size_t> first_blocking(const Params& params, const vector<Point>& blocks, size_t first, Point start, Point end)
+{
+    constexpr size_t kNever = numeric_limits<size_t>::max();
+
+    // A one-cell wall around the grid means neighbors never need a bounds check.
+    Board grid{params.h, params.w, '.', 1, '#'};
+    const auto stride = static_cast<size_t>(grid.stride());
+
+    // A block that lands on an already-blocked cell changes nothing, so each
+    // cell only cares about the first block to land on it.
+    vector<size_t> dropped_at(grid.buffer_size(), kNever);
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        auto ix = grid.index_of(blocks[i]);
+        if (dropped_at[ix] == kNever)
+        {
+            dropped_at[ix] = i;
+            grid[ix] = '#';
         }
+    }
 
-        for (const auto& n : board.cardinal_neighbors(p))
+    DisjointSets sets{grid.buffer_size()};
+    auto open = [&](size_t ix)
+    {
+        grid[ix] = '.';
+        for (size_t n : {ix - stride, ix + 1, ix + stride, ix - 1})
         {
-            if (board[n] == '#')
+            if (grid[n] != '#')
             {
-                continue;
+                sets.unite(static_cast<uint32_t>(ix), static_cast<uint32_t>(n));
             }
+        }
+    };
 
-            q.push_back(n);
+    for (int y = 0; y < grid.num_rows(); ++y)
+    {
+        for (int x = 0; x < grid.num_cols(); ++x)
+        {
+            auto ix = grid.index_of({x, y});
+            if (grid[ix] != '#')
+            {
+                open(ix);
+            }
+        }
+    }
+
+    const auto s = static_cast<uint32_t>(grid.index_of(start));
+    const auto e = static_cast<uint32_t>(grid.index_of(end));
+    auto connected = [&] { return grid[s] != '#' && grid[e] != '#' && sets.find(s) == sets.find(e); };
+
+    if (connected())
+    {
+        return nullopt;
+    }
+
+    for (size_t i = blocks.size(); i-- > first; )
+    {
+        auto ix = grid.index_of(blocks[i]);
+        if (dropped_at[ix] != i)
+        {
+            continue;
+        }
+
+        open(ix);
+        if (connected())
+        {
+            return i;
         }
     }
 
-    return false;
+    throw logic_error{"start and end are disconnected before the first checked block"};
 }
 
 } // namespace
@@ -233,7 +297,7 @@ string PartOne::solve()
     // dbg() << copy << endl;
     // return path.empty() ? "none" : to_string(path.size() - 1); // counting steps, so the start point doesn't count
 
-    auto path = dijkstra(puzzle.board, start, end);
+    auto path = shortest_path(puzzle.board, start, end);
 
     puzzle.board.draw(dbg(), path);
 
@@ -248,13 +312,13 @@ string PartTwo::solve()
     auto params = get_params();
     auto puzzle = read_input(params);
 
-    size_t applied = params.s;
-    while (is_reachable(puzzle.board, Point{0, 0}, Point{params.w - 1, params.h - 1}))
+    auto blocker = first_blocking(params, puzzle.blocks, params.s, Point{0, 0}, Point{params.w - 1, params.h - 1});
+    if (!blocker)
     {
-        puzzle.board[puzzle.blocks[applied++]] = '#';
+        throw logic_error{"the exit is never cut off"};
     }
 
-    Point p = puzzle.blocks[applied - 1];
+    Point p = puzzle.blocks[*blocker];
     stringstream ss;
     ss << p.x() << ',' << p.y();
 
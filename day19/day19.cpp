@@ -1,18 +1,14 @@
 #include "day19.h"
 
-#include <algorithm>
-#include <array>
+#include "dawg.h"
+
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iostream>
 #include <memory>
-#include <numeric>
-#include <ranges>
 #include <sstream>
 #include <string>
-#include <string_view>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -91,70 +87,58 @@ Puzzle read_input()
     return Puzzle{towels, patterns};
 }
 
-bool can_form_pattern(const unordered_set<string>& towel_set, const string& pattern)
+/**
+ * @brief Counts the ways to make `pattern` from towels in `towels`.
+ *
+ * ways[i] is the number of arrangements of the first i stripes.  From each
+ * reachable i, one walk down the DAWG finds every towel that fits there,
+ * so the cost depends on the pattern and the longest towel, not on how
+ * many towels there are.
+ */
+uintmax_t count_arrangements(const Dawg& towels, const string& pattern, vector<uintmax_t>& ways)
 {
     size_t n = pattern.size();
-    vector<bool> dp(n + 1, false);
-
-    dp[0] = true;
+    ways.assign(n + 1, 0);
+    ways[0] = 1;
 
-    for (size_t i = 1; i <= n; ++i)
+    for (size_t i = 0; i < n; ++i)
     {
-        for (size_t j = 0; j < i; ++j)
+        if (ways[i] == 0)
         {
-            if (dp[j] && towel_set.contains(pattern.substr(j, i - j)))
-            {
-                dp[i] = true;
-                break;
-            }
+            continue;
         }
-    }
 
-    return dp[n];
-}
-
-class Counter
-{
-    unordered_map<string_view, uintmax_t> counts_;
-
-public:
-    uintmax_t count_combos(const vector<string>& towels, string_view pattern)
-    {
-        if (pattern.empty())
+        Dawg::Node node = towels.root();
+        for (size_t j = i; j < n; ++j)
         {
-            return 1;
-        }
-
-        if (auto it = counts_.find(pattern); it != counts_.end())
-        {
-            return it->second;
-        }
+            node = towels.next(node, pattern[j]);
+            if (node == 0)
+            {
+                break;
+            }
 
-        uintmax_t num_combos = 0;
-        for (const auto& towel : towels)
-        {
-            if (pattern.starts_with(towel))
+            if (towels.eow(node))
             {
-                num_combos += count_combos(towels, pattern.substr(towel.size()));
+                ways[j + 1] += ways[i];
             }
         }
-
-        counts_[pattern] = num_combos;
-
-        return num_combos;
     }
-};
+
+    return ways[n];
+}
 
 } // namespace
 
 string PartOne::solve()
 {
     Puzzle p = read_input();
+    auto towels = BuildDawg(p.towels);
+
     size_t num_possible = 0;
-    unordered_set<string> towel_set(p.towels.begin(), p.towels.end());
+    vector<uintmax_t> ways;
     for (const auto& pattern : p.patterns)
     {
-        if (can_form_pattern(towel_set, pattern))
+        if (count_arrangements(*towels, pattern, ways) > 0)
         {
             ++num_possible;
         }
@@ -165,12 +149,13 @@ string PartOne::solve()
 string PartTwo::solve()
 {
     Puzzle p = read_input();
+    auto towels = BuildDawg(p.towels);
 
     uintmax_t count = 0;
+    vector<uintmax_t> ways;
     for (const auto& pattern : p.patterns)
     {
-        Counter counter;
-        count += counter.count_combos(p.towels, pattern);
+        count += count_arrangements(*towels, pattern, ways);
     }
 
     return to_string(count);
@@ -1,6 +1,7 @@
 #include "day20.h"
 
 #include "board.h"
+#include "graph_search.h"
 #include "parsers.h"
 #include "point.h"
 
@@ -9,14 +10,13 @@
 #include <execution>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <optional>
-#include <queue>
 #include <ranges>
 #include <sstream>
 #include <string>
-#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -58,57 +58,28 @@ unique_ptr<istream> get_input()
     return make_unique<ifstream>(kInputFile);
 }
 
-vector<Point> dijkstra(const Board& board, Point start, Point end)
+vector<Point> shortest_path(const Board& board, Point start, Point end)
 {
-    unordered_map<Point, size_t> dist;
-    unordered_map<Point, Point> prev;
-
-    // pq is a min-queue - smallest element first.
-    // pairs compare lexicographically, so weight comes first.
-    priority_queue<pair<size_t, Point>, vector<pair<size_t, Point>>, greater<>> pq;
-
-    dist.reserve(board.num_rows() * board.num_cols());
-    for (auto p : board.all_points())
+    Board padded = board.with_border(1, '#');
+    auto paths = search::dijkstra(
+        padded.buffer_size(),
+        static_cast<search::Node>(padded.index_of(start)),
+        1,
+        search::cardinal_moves(padded, [](char c) { return c != '#'; })
+    );
+
+    auto cells = paths.path_to(static_cast<search::Node>(padded.index_of(end)));
+    if (cells.empty())
     {
-        dist[p] = numeric_limits<size_t>::max();
-    }
-
-    pq.push({0, start});
-    dist[start] = 0;
-
-    while (!pq.empty())
-    {
-        auto [w, p] = pq.top();
-        pq.pop();
-
-        for (const auto& n : board.cardinal_neighbors(p))
-        {
-            if (board[n] == '#')
-            {
-                continue;
-            }
-
-            size_t alt = dist[p] + 1;
-            if (alt < dist[n])
-            {
-                dist[n] = alt;
-                prev[n] = p;
-                pq.push({alt, n});
-            }
-        }
+        throw logic_error{"no path found"};
     }
 
     vector<Point> path;
-
-    path.reserve(dist[end]);
-    for (Point cur = end; cur != start; cur = prev[cur])
+    path.reserve(cells.size());
+    for (auto cell : cells)
     {
-        path.push_back(cur);
+        path.push_back(padded.point_of(cell));
     }
-    path.push_back(start);
-
-    reverse(path.begin(), path.end());
-
     return path;
 }
 
@@ -131,12 +102,14 @@ string PartOne::solve()
         }
     }
 
-    vector<Point> vanilla_path = dijkstra(board, start, end);
+    vector<Point> vanilla_path = shortest_path(board, start, end);
 
-    unordered_map<Point, size_t> indices_by_point;
+    // Position of each cell along the path, indexed by board cell.
+    constexpr size_t kOffPath = numeric_limits<size_t>::max();
+    vector<size_t> path_index(board.buffer_size(), kOffPath);
     for (size_t i = 0; i < vanilla_path.size(); ++i)
     {
-        indices_by_point[vanilla_path[i]] = i;
+        path_index[board.index_of(vanilla_path[i])] = i;
     }
 
     // Find all pairs that are separated by one wall.
@@ -184,16 +157,21 @@ string PartOne::solve()
                 continue;
             }
 
-            auto it = indices_by_point.find(dest);
-            if (it == indices_by_point.end() || it->second < i)
+            if (!board.in_bounds(dest))
+            {
+                continue;
+            }
+
+            auto j = path_index[board.index_of(dest)];
+            if (j == kOffPath || j < i)
             {
                 continue;
             }
 
-            auto sv = it->second - i - 2;
+            auto sv = j - i - 2;
             if (sv >= 100)
             {
-                dbg() << "Cheat at " << wall << "maybe saves " << (it->second - i - 2) << " moves" << endl;
+                dbg() << "Cheat at " << wall << "maybe saves " << sv << " moves" << endl;
                 ++num_good_cheats;
             }
         }
@@ -219,7 +197,7 @@ string PartTwo::solve()
         }
     }
 
-    vector<Point> vanilla_path = dijkstra(board, start, end);
+    vector<Point> vanilla_path = shortest_path(board, start, end);
 
     size_t num_good_cheats = 0;
     for (int i = 0; i < static_cast<int>(vanilla_path.size()) - 1; i++)
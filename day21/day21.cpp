@@ -4,17 +4,19 @@
 #include "point.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
 #include <exception>
 #include <fstream>
+#include <initializer_list>
 #include <iostream>
+#include <limits>
 #include <memory>
-#include <numeric>
-#include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -34,225 +36,238 @@ constexpr const char* kTestInput = R"(
 456A
 379A)";
 
-const unordered_map<char, Point> keypad_points_by_char{
-    { '7', Point(0, 0) },
-    { '8', Point(1, 0) },
-    { '9', Point(2, 0) },
-    { '4', Point(0, 1) },
-    { '5', Point(1, 1) },
-    { '6', Point(2, 1) },
-    { '1', Point(0, 2) },
-    { '2', Point(1, 2) },
-    { '3', Point(2, 2) },
-    { ' ', Point(0, 3) },
-    { '0', Point(1, 3) },
-    { 'A', Point(2, 3) },
-};
+// Costs saturate here rather than wrapping; anything this large is
+// already beyond what a complexity can be reported as.
+constexpr uint64_t kUnreachable = numeric_limits<uint64_t>::max();
 
-class Robot
+uint64_t saturating_add(uint64_t a, uint64_t b)
 {
-    unordered_map<char, unordered_map<char, size_t>> costs_;
-    Robot* derived_;
+    return a > kUnreachable - b ? kUnreachable : a + b;
+}
+
+uint64_t saturating_mul(uint64_t a, uint64_t b)
+{
+    return b != 0 && a > kUnreachable / b ? kUnreachable : a * b;
+}
+
+/**
+ * @brief A keypad layout, with its keys numbered densely in reading order.
+ *
+ * The gap - the one position a robot arm may never pass over - is written
+ * as a space.
+ */
+template <size_t N>
+class Keypad
+{
+    array<char, N> keys_;
+    array<Point, N> points_;
+    Point gap_;
+    array<int8_t, 128> index_;
 
 public:
-    Robot() = default;
-    Robot(initializer_list<pair<char, initializer_list<pair<char, size_t>>>> costs)
-        : costs_{}
-        , derived_{nullptr}
+    explicit Keypad(initializer_list<string_view> rows)
+        : keys_{}
+        , points_{}
+        , gap_{-1, -1}
     {
-        for (const auto& row : costs)
+        index_.fill(-1);
+
+        size_t n = 0;
+        int y = 0;
+        for (string_view row : rows)
         {
-            unordered_map<char, size_t> m;
-            for (const auto& [c,cost] : row.second)
+            for (int x = 0; x < static_cast<int>(row.size()); ++x)
             {
-                m[c] = cost;
+                char c = row[static_cast<size_t>(x)];
+                if (c == ' ')
+                {
+                    gap_ = Point{x, y};
+                    continue;
+                }
+                if (n == N)
+                {
+                    throw logic_error{"too many keys for this keypad"};
+                }
+                keys_[n] = c;
+                points_[n] = Point{x, y};
+                index_[static_cast<unsigned char>(c)] = static_cast<int8_t>(n);
+                n++;
             }
-            costs_[row.first] = std::move(m);
+            y++;
+        }
+
+        if (n != N)
+        {
+            throw logic_error{"too few keys for this keypad"};
         }
     }
 
-    ~Robot()
+    size_t index_of(char key) const
     {
-        if (derived_ != nullptr)
+        int8_t ix = static_cast<unsigned char>(key) < index_.size() ? index_[static_cast<unsigned char>(key)] : -1;
+        if (ix < 0)
         {
-            delete derived_;
+            throw runtime_error{"no such key: " + string(1, key)};
         }
+        return static_cast<size_t>(ix);
     }
 
-    size_t cost_to_move(char from, char to) const
+    Point point_of(size_t ix) const
     {
-        return costs_.at(from).at(to);
+        return points_[ix];
     }
 
-    Robot* derive()
+    bool is_gap(Point p) const
     {
-        if (derived_ == nullptr)
+        return p == gap_;
+    }
+};
+
+// costs[from][to] is how many buttons the human must press to have the
+// arm over some keypad travel from key `from` to key `to` and press it.
+template <size_t N>
+using Costs = array<array<uint64_t, N>, N>;
+
+constexpr size_t kNumDirectionalKeys = 5;
+constexpr size_t kNumNumericKeys = 11;
+
+using DirectionalCosts = Costs<kNumDirectionalKeys>;
+
+const Keypad<kNumDirectionalKeys> kDirectionalKeypad{
+    " ^A",
+    "<v>",
+};
+
+const Keypad<kNumNumericKeys> kNumericKeypad{
+    "789",
+    "456",
+    "123",
+    " 0A",
+};
+
+/**
+ * @brief Derives the press costs for `pad` from the press costs of the
+ *        directional keypad that drives it.
+ *
+ * The cheapest way between two keys always makes all its moves along one
+ * axis before the other; mixing them only adds direction changes upstream.
+ * That leaves at most two routes per pair, and a route is priced by
+ * summing the driver's costs along the key sequence A, moves..., A - a
+ * min-plus product of the driver's cost matrix with the route.
+ */
+template <size_t N>
+Costs<N> press_costs(const Keypad<N>& pad, const DirectionalCosts& driver)
+{
+    static const size_t kActivate = kDirectionalKeypad.index_of('A');
+    static const size_t kUp = kDirectionalKeypad.index_of('^');
+    static const size_t kDown = kDirectionalKeypad.index_of('v');
+    static const size_t kLeft = kDirectionalKeypad.index_of('<');
+    static const size_t kRight = kDirectionalKeypad.index_of('>');
+
+    // Cost of pressing `first` n1 times and then `second` n2 times, starting
+    // and ending on the driver's A.
+    auto route = [&driver](size_t first, uint64_t n1, size_t second, uint64_t n2) {
+        size_t cur = kActivate;
+        uint64_t cost = 0;
+        for (auto [key, n] : {pair{first, n1}, pair{second, n2}})
         {
-            derived_ = new Robot{{
-                { 'A', {
-                    { 'A', cost_of("") },
-                    { '^', cost_of("<") },
-                    { '>', cost_of("v") },
-                    { 'v', min(cost_of("<v"), cost_of("v<")) },
-                    { '<', min(cost_of("v<<"), cost_of("<v<")) }, // no <<v, blank space
-                } },
-                { '^', {
-                    { 'A', cost_of(">") },
-                    { '^', cost_of("") },
-                    { '>', min(cost_of("v>"), cost_of(">v")) },
-                    { 'v', cost_of("v") },
-                    { '<', cost_of("v<") }, // no <v, blank space
-                } },
-                { '>', {
-                    { 'A', cost_of("^") },
-                    { '^', min(cost_of("^<"), cost_of("<^")) },
-                    { '>', cost_of("") },
-                    { 'v', cost_of("<") },
-                    { '<', cost_of("<<") },
-                } },
-                { 'v', {
-                    { 'A', min(cost_of(">^"), cost_of("^>")) },
-                    { '^', cost_of("^") },
-                    { '>', cost_of(">") },
-                    { 'v', cost_of("") },
-                    { '<', cost_of("<") },
-                } },
-                { '<', {
-                    { 'A', min(cost_of(">>^"), cost_of(">^>")) }, // no ^>>, blank space
-                    { '^', cost_of(">^") }, // no ^>
-                    { '>', cost_of(">>") },
-                    { 'v', cost_of(">") },
-                    { '<', cost_of("") },
-                } },
-            }};
+            if (n == 0)
+            {
+                continue;
+            }
+            cost = saturating_add(cost, driver[cur][key]);
+            cost = saturating_add(cost, saturating_mul(n - 1, driver[key][key]));
+            cur = key;
         }
+        return saturating_add(cost, driver[cur][kActivate]);
+    };
 
-        return derived_;
-    }
-
-private:
-    size_t cost_of(string_view str) const
+    Costs<N> costs;
+    for (size_t i = 0; i < N; ++i)
     {
-        char cur = 'A';
-        size_t cost = 0;
-        for (char c : str)
+        Point from = pad.point_of(i);
+        for (size_t j = 0; j < N; ++j)
         {
-            cost += cost_to_move(cur, c) + 1;
-            cur = c;
+            Point to = pad.point_of(j);
+            int dx = to.x() - from.x();
+            int dy = to.y() - from.y();
+            size_t h = dx < 0 ? kLeft : kRight;
+            size_t v = dy < 0 ? kUp : kDown;
+            auto nx = static_cast<uint64_t>(abs(dx));
+            auto ny = static_cast<uint64_t>(abs(dy));
+
+            uint64_t best = kUnreachable;
+            if (!pad.is_gap(Point{to.x(), from.y()}))
+            {
+                best = min(best, route(h, nx, v, ny));
+            }
+            if (!pad.is_gap(Point{from.x(), to.y()}))
+            {
+                best = min(best, route(v, ny, h, nx));
+            }
+            costs[i][j] = best;
         }
-        cost += cost_to_move(cur, 'A'); // gotta move back to A
-        return cost;
     }
-};
+    return costs;
+}
+
+/**
+ * @brief Press costs for the numeric keypad at the end of a chain of
+ *        `num_robots` directional-keypad robots, the first of which is
+ *        driven by a human.
+ */
+Costs<kNumNumericKeys> numeric_costs(size_t num_robots)
+{
+    // The human presses buttons directly: one press each, whatever the move.
+    DirectionalCosts costs;
+    for (auto& row : costs)
+    {
+        row.fill(1);
+    }
+
+    for (size_t i = 0; i < num_robots; ++i)
+    {
+        costs = press_costs(kDirectionalKeypad, costs);
+    }
+    return press_costs(kNumericKeypad, costs);
+}
 
 class Puzzle
 {
     vector<string> codes_;
-    Robot* base_robot_;
 
 public:
     Puzzle(vector<string>&& codes)
         : codes_(std::move(codes))
-        , base_robot_(nullptr)
     {
-        base_robot_ = new Robot{{
-            { 'A', { { 'A', 0 }, {'^', 0}, {'>', 0}, {'v', 0}, {'<', 0} } },
-            { '^', { { 'A', 0 }, {'^', 0}, {'>', 0}, {'v', 0}, {'<', 0} } },
-            { '>', { { 'A', 0 }, {'^', 0}, {'>', 0}, {'v', 0}, {'<', 0} } },
-            { 'v', { { 'A', 0 }, {'^', 0}, {'>', 0}, {'v', 0}, {'<', 0} } },
-            { '<', { { 'A', 0 }, {'^', 0}, {'>', 0}, {'v', 0}, {'<', 0} } },
-        }};
     }
 
-    ~Puzzle()
+    uint64_t total_complexity(size_t num_robots) const
     {
-        delete base_robot_;
-    }
+        auto costs = numeric_costs(num_robots);
 
-    const vector<string>& codes() const
-    {
-        return codes_;
-    }
-
-    size_t cost_of_code(const string& code, size_t num_dirpads) const
-    {
-        char cur = 'A';
-        size_t cost = 0;
-        for (char c : code)
+        uint64_t total = 0;
+        for (const auto& code : codes_)
         {
-            cost += cost_to_move(cur, c, base_robot_, num_dirpads);
-            cur = c;
-        }
-        return cost;
-    }
+            size_t cur = kNumericKeypad.index_of('A');
+            uint64_t cost = 0;
+            for (char c : code)
+            {
+                size_t next = kNumericKeypad.index_of(c);
+                cost = saturating_add(cost, costs[cur][next]);
+                cur = next;
+            }
 
-private:
-    size_t cost_to_move(char from, char to, Robot* robot, size_t num_remaining_robots) const
-    {
-        if (num_remaining_robots > 1)
-        {
-            // This part of the recursive call is a robot controlling a dpad
-            Robot* derived = robot->derive();
-            return cost_to_move(from, to, derived, num_remaining_robots - 1);
+            uint64_t code_number = stoz(code.substr(0, code.size() - 1)); // remove final 'A'
+            dbg() << "code=" << code << "; code_number=" << code_number << "; code_cost=" << cost << endl;
+            total = saturating_add(total, saturating_mul(cost, code_number));
         }
 
-        // This is the innermost dirpad - we must translate the keypad 'from'
-        // and 'to' chars into dpad moves, and calculate the cost of those moves
-        // using the derived robot.
-        auto pFrom = keypad_points_by_char.at(from);
-        auto pTo = keypad_points_by_char.at(to);
-
-        auto dx = pTo.x() - pFrom.x();
-        auto dy = pTo.y() - pFrom.y();
-
-        auto dy_char = dy < 0 ? '^' : 'v';
-        auto dx_char = dx < 0 ? '<' : '>';
-
-        if (dx == 0 && dy == 0)
-        {
-            // already there!  just press the button.
-            return 1;
-        }
-        else if (dx == 0)
-        {
-            // only vertical moves - known safe.
-            return robot->cost_to_move('A', dy_char) + abs(dy) + robot->cost_to_move(dy_char, 'A') + 1;
-        }
-        else if (dy == 0)
-        {
-            // only horizontal moves - known safe.
-            return robot->cost_to_move('A', dx_char) + abs(dx) + robot->cost_to_move(dx_char, 'A') + 1;
-        }
-        else if (pFrom.x() == 0 && pTo.y() == 3)
+        if (total == kUnreachable)
         {
-            // we're in danger of crossing the blank space -
-            // do horizontal moves first.
-            return robot->cost_to_move('A', dx_char) + abs(dx)
-                + robot->cost_to_move(dx_char, dy_char) + abs(dy)
-                + robot->cost_to_move(dy_char, 'A') + 1;
-        }
-        else if (pFrom.y() == 3 && pTo.x() == 0)
-        {
-            // we're in danger of crossing the blank space -
-            // do vertical moves first.
-            return robot->cost_to_move('A', dy_char) + abs(dy)
-                + robot->cost_to_move(dy_char, dx_char) + abs(dx)
-                + robot->cost_to_move(dx_char, 'A') + 1;
-        }
-        else
-        {
-            // no danger of crossing the blank - could do horizontals
-            // or verticals first; pick whichever is cheaper.
-            return min(
-                robot->cost_to_move('A', dx_char) + abs(dx)
-                + robot->cost_to_move(dx_char, dy_char) + abs(dy)
-                + robot->cost_to_move(dy_char, 'A') + 1,
-
-                robot->cost_to_move('A', dy_char) + abs(dy)
-                + robot->cost_to_move(dy_char, dx_char) + abs(dx)
-                + robot->cost_to_move(dx_char, 'A') + 1
-            );
+            throw overflow_error{"Overflow"};
         }
+        return total;
     }
 };
 
@@ -279,36 +294,18 @@ unique_ptr<Puzzle> read_input()
 
 string PartOne::solve()
 {
-    constexpr const size_t num_dirpads = 3;
+    constexpr const size_t num_robots = 2;
 
     auto puzzle = read_input();
-    size_t total_cost = 0;
-    for (const auto& code : puzzle->codes())
-    {
-        string code_copy = code.substr(0, code.size() - 1); // remove final 'A'
-        size_t code_number = stoz(code_copy);
-        size_t code_cost = puzzle->cost_of_code(code, num_dirpads);
-        dbg() << "code=" << code << "; code_number=" << code_number << "; code_cost=" << code_cost << endl;
-        total_cost += code_cost * code_number;
-    }
-    return to_string(total_cost);
+    return to_string(puzzle->total_complexity(num_robots));
 }
 
 string PartTwo::solve()
 {
-    constexpr const size_t num_dirpads = 26;
+    constexpr const size_t num_robots = 25;
 
     auto puzzle = read_input();
-    size_t total_cost = 0;
-    for (const auto& code : puzzle->codes())
-    {
-        string code_copy = code.substr(0, code.size() - 1); // remove final 'A'
-        size_t code_number = stoz(code_copy);
-        size_t code_cost = puzzle->cost_of_code(code, num_dirpads);
-        dbg() << "code=" << code << "; code_number=" << code_number << "; code_cost=" << code_cost << endl;
-        total_cost += code_cost * code_number;
-    }
-    return to_string(total_cost);
+    return to_string(puzzle->total_complexity(num_robots));
 }
 
 } // namespace day21
@@ -3,19 +3,23 @@
 #include "parsers.h"
 
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
 #include <exception>
 #include <execution>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <numeric>
-#include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <thread>
 #include <utility>
 #include <vector>
+#include <version>
 
 using namespace std;
 
@@ -99,68 +103,133 @@ public:
 constexpr const Buffer kMaxBuffer(9, 9, 9, 9);
 constexpr const size_t kMaxIndex = kMaxBuffer.to_index() + 1;
 
-using SeenArray = std::array<bool, kMaxIndex>;
 using PriceArray = std::array<int, kMaxIndex>;
 
+// How many buyers' secrets are advanced together.  mix() is only shifts,
+// xors and masks on 24-bit values, so eight 32-bit lanes fit one AVX2
+// register (or two SSE registers).
+constexpr size_t kLanes = 8;
+
+using Lanes = std::array<uint32_t, kLanes>;
+
+constexpr void mix(uint32_t& s)
+{
+    s = (s ^ (s <<  6)) & 0xFFFFFF;
+    s = (s ^ (s >>  5)) & 0xFFFFFF;
+    s = (s ^ (s << 11)) & 0xFFFFFF;
+}
+
+// Written as a plain loop over lanes so that the compiler vectorizes it.
+void mix(Lanes& lanes)
+{
+    for (auto& s : lanes)
+    {
+        mix(s);
+    }
+}
+
 class Buyer
 {
-    size_t secret_;
+    uint32_t secret_;
 
 public:
     Buyer(size_t secret)
-        : secret_(secret)
+        : secret_(static_cast<uint32_t>(secret & 0xFFFFFF))
     {
     }
 
-    size_t iter(size_t num_iters) const
+    uint32_t secret() const
     {
-        size_t s = secret_;
-        for (size_t i = 0; i < num_iters; ++i)
-        {
-            mix(s);
-        }
-        return s;
+        return secret_;
     }
+};
 
-    [[maybe_unused]]
-    void find_best_prefixes(size_t max_iters, SeenArray& seen, PriceArray& prices) const
+Lanes load_lanes(span<const Buyer> buyers)
+{
+    Lanes lanes{};
+    for (size_t lane = 0; lane < buyers.size(); ++lane)
     {
-        Buffer buf;
-        size_t s = secret_;
-        int price = static_cast<int>(s % 10);
+        lanes[lane] = buyers[lane].secret();
+    }
+    return lanes;
+}
+
+/**
+ * @brief Totals, for each sequence of four price changes, what the buyers
+ *        it's given would pay on first seeing it.
+ *
+ * Whether a buyer has seen a sequence yet is a per-sequence stamp holding
+ * the last buyer that saw it, so moving on to the next buyer is just
+ * bumping a counter; the stamps are only cleared when the counter wraps.
+ * Buyers' secrets are advanced kLanes at a time, but each buyer is then
+ * scored on its own, since the stamps only track one buyer at a time.
+ */
+class PrefixScorer
+{
+    PriceArray prices_{};
+    array<uint16_t, kMaxIndex> seen_{};
+    uint16_t generation_ = 0;
+
+    // One row per step, one column per lane.
+    vector<array<int8_t, kLanes>> history_;
+
+public:
+    const PriceArray& prices() const
+    {
+        return prices_;
+    }
 
-        fill(seen.begin(), seen.end(), false);
+    // Scores up to kLanes buyers, generating their prices together.
+    void score(span<const Buyer> buyers, size_t num_iters)
+    {
+        history_.resize(num_iters + 1);
 
-        for (size_t i = 0; i < max_iters; ++i)
+        Lanes secrets = load_lanes(buyers);
+        for (size_t i = 0; i <= num_iters; ++i)
         {
-            mix(s);
-            int new_price = static_cast<int>(s % 10);
+            for (size_t lane = 0; lane < kLanes; ++lane)
+            {
+                history_[i][lane] = static_cast<int8_t>(secrets[lane] % 10);
+            }
+            mix(secrets);
+        }
 
-            int delta = new_price - price;
-            buf.push(delta);
-            price = new_price;
+        for (size_t lane = 0; lane < buyers.size(); ++lane)
+        {
+            score_lane(lane, num_iters);
+        }
+    }
+
+private:
+    void score_lane(size_t lane, size_t num_iters)
+    {
+        if (generation_ == numeric_limits<uint16_t>::max())
+        {
+            fill(seen_.begin(), seen_.end(), uint16_t{0});
+            generation_ = 0;
+        }
+        ++generation_;
 
-            if (i < 3)
+        Buffer buf;
+        for (size_t i = 1; i <= num_iters; ++i)
+        {
+            int price = history_[i][lane];
+            buf.push(price - history_[i - 1][lane]);
+
+            if (i < 4)
             {
                 // Dont' have enough deltas to make a prefix yet
                 continue;
             }
 
-            if (!seen[buf.to_index()])
+            size_t ix = buf.to_index();
+            if (seen_[ix] != generation_)
             {
-                seen[buf.to_index()] = true;
-                prices[buf.to_index()] += price;
+                seen_[ix] = generation_;
+                prices_[ix] += price;
             }
         }
     }
-
-private:
-    static constexpr void mix(size_t& s)
-    {
-        s = (s ^ (s <<  6)) & 0xFFFFFF;
-        s = (s ^ (s >>  5)) & 0xFFFFFF;
-        s = (s ^ (s << 11)) & 0xFFFFFF;
-    }
 };
 
 /*
@@ -208,14 +277,29 @@ vector<Buyer> read_input()
 string PartOne::solve()
 {
     auto buyers = read_input();
+
+    vector<size_t> batches;
+    for (size_t i = 0; i < buyers.size(); i += kLanes)
+    {
+        batches.push_back(i);
+    }
+
     auto sum = transform_reduce(
-        //execution::par_unseq,
-        buyers.begin(),
-        buyers.end(),
+#if __cpp_lib_parallel_algorithm
+        execution::par,
+#endif
+        batches.begin(),
+        batches.end(),
         0_um,
         plus{},
-        [](const Buyer& buyer) {
-            return static_cast<uintmax_t>(buyer.iter(2000));
+        [&](size_t start) {
+            auto batch = span{buyers}.subspan(start, min(kLanes, buyers.size() - start));
+            Lanes secrets = load_lanes(batch);
+            for (size_t i = 0; i < 2000; ++i)
+            {
+                mix(secrets);
+            }
+            return accumulate(secrets.begin(), secrets.begin() + static_cast<ptrdiff_t>(batch.size()), 0_um);
         }
     );
     return to_string(sum);
@@ -226,20 +310,39 @@ string PartTwo::solve()
     size_t num_iters = 2000;
     auto buyers = read_input();
 
-    unique_ptr<SeenArray> seen_prefixes = make_unique<SeenArray>();
-    unique_ptr<PriceArray> prices_by_prefix = make_unique<PriceArray>();
-
-    fill(prices_by_prefix->begin(), prices_by_prefix->end(), 0);
+    // Each shard scores a contiguous run of buyers into its own arrays, and
+    // the shards' totals are added up at the end.
+    size_t num_shards = min<size_t>(max(1u, thread::hardware_concurrency()), (buyers.size() + kLanes - 1) / kLanes);
+    num_shards = max<size_t>(num_shards, 1);
+    vector<unique_ptr<PrefixScorer>> shards;
+    for (size_t i = 0; i < num_shards; ++i)
+    {
+        shards.push_back(make_unique<PrefixScorer>());
+    }
 
     for_each(
-        execution::seq,
-        buyers.begin(), buyers.end(),
-        [&seen_prefixes, &prices_by_prefix, num_iters](const Buyer& buyer) {
-            buyer.find_best_prefixes(num_iters, *seen_prefixes, *prices_by_prefix);
+#if __cpp_lib_parallel_algorithm
+        execution::par,
+#endif
+        shards.begin(), shards.end(),
+        [&](unique_ptr<PrefixScorer>& shard) {
+            size_t ix = static_cast<size_t>(&shard - shards.data());
+            size_t begin = buyers.size() * ix / num_shards;
+            size_t end = buyers.size() * (ix + 1) / num_shards;
+            for (size_t i = begin; i < end; i += kLanes)
+            {
+                shard->score(span{buyers}.subspan(i, min(kLanes, end - i)), num_iters);
+            }
         }
     );
 
-    auto best_price = *max_element(prices_by_prefix->begin(), prices_by_prefix->end());
+    PriceArray prices{};
+    for (const auto& shard : shards)
+    {
+        transform(prices.begin(), prices.end(), shard->prices().begin(), prices.begin(), plus{});
+    }
+
+    auto best_price = *max_element(prices.begin(), prices.end());
 
     dbg("best price: {}", best_price);
 
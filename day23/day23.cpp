@@ -1,21 +1,21 @@
 #include "day23.h"
 
+#include "input_cache.h"
 #include "parsers.h"
 
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <numeric>
-#include <ranges>
-#include <set>
+#include <span>
 #include <sstream>
-#include <stack>
 #include <string>
-#include <string_view>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -94,135 +94,416 @@ vector<pair<string, string>> read_input()
     return connections;
 }
 
-} // namespace
 
-string PartOne::solve()
+/**
+ * @brief The LAN as an undirected graph over dense integer node ids.
+ *
+ * Names are interned in order of first appearance.  Adjacency is kept as
+ * sorted neighbor lists in one flat array, and nodes are ranked in a
+ * degeneracy order (repeatedly removing a node of minimum remaining
+ * degree), so that every node has few neighbors ranked after it.
+ */
+class Network
 {
-    auto connections = read_input();
-    unordered_set<string> computers;
-    for (const auto& [a, b] : connections)
+    static constexpr uint32_t kNone = numeric_limits<uint32_t>::max();
+
+    vector<string> names_;
+    vector<size_t> offsets_;
+    vector<uint32_t> neighbors_;
+    vector<uint32_t> order_;
+    vector<uint32_t> rank_;
+    size_t max_degree_ = 0;
+
+public:
+    explicit Network(const vector<pair<string, string>>& connections)
     {
-        computers.insert(a);
-        computers.insert(b);
+        unordered_map<string, uint32_t> ids;
+        auto intern = [&](const string& name) {
+            auto [it, inserted] = ids.try_emplace(name, static_cast<uint32_t>(names_.size()));
+            if (inserted)
+            {
+                names_.push_back(name);
+            }
+            return it->second;
+        };
+
+        vector<pair<uint32_t, uint32_t>> edges;
+        edges.reserve(connections.size() * 2);
+        for (const auto& [a, b] : connections)
+        {
+            uint32_t x = intern(a);
+            uint32_t y = intern(b);
+            if (x != y)
+            {
+                edges.emplace_back(x, y);
+                edges.emplace_back(y, x);
+            }
+        }
+        sort(edges.begin(), edges.end());
+        edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+        offsets_.assign(size() + 1, 0);
+        neighbors_.reserve(edges.size());
+        for (const auto& [x, y] : edges)
+        {
+            offsets_[x + 1]++;
+            neighbors_.push_back(y);
+        }
+        partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+        for (uint32_t v = 0; v < size(); ++v)
+        {
+            max_degree_ = max(max_degree_, degree(v));
+        }
+
+        compute_degeneracy_order();
+    }
+
+    size_t size() const
+    {
+        return names_.size();
     }
 
-    unordered_map<string, unordered_set<string>> connections_by_node;
-    for (const auto& [a, b] : connections)
+    const string& name(uint32_t v) const
     {
-        connections_by_node[a].insert(b);
-        connections_by_node[b].insert(a);
+        return names_[v];
     }
 
-    vector<string> nodes(computers.begin(), computers.end());
+    span<const uint32_t> neighbors(uint32_t v) const
+    {
+        return {neighbors_.data() + offsets_[v], neighbors_.data() + offsets_[v + 1]};
+    }
 
-    size_t num_t_groups = 0;
-    for (size_t x = 0; x < nodes.size() - 2; x++)
+    size_t degree(uint32_t v) const
     {
-        for (size_t y = x + 1; y < nodes.size() - 1; ++y)
+        return offsets_[v + 1] - offsets_[v];
+    }
+
+    /**
+     * @brief Counts the triangles with at least one node matching `pred`.
+     *
+     * Each triangle is found exactly once, from its lowest-ranked node.
+     */
+    template <typename Pred>
+    size_t count_triangles(Pred&& pred) const
+    {
+        vector<uint32_t> mark(size(), kNone);
+        size_t count = 0;
+
+        for (uint32_t u : order_)
         {
-            for (size_t z = y + 1; z < nodes.size(); ++z)
+            for (uint32_t v : neighbors(u))
             {
-                if (nodes[x][0] == 't' || nodes[y][0] == 't' || nodes[z][0] == 't')
+                if (rank_[v] > rank_[u])
                 {
-                    const string& a = nodes[x];
-                    const string& b = nodes[y];
-                    const string& c = nodes[z];
+                    mark[v] = u;
+                }
+            }
 
-                    if (auto it = connections_by_node[a].find(b); it == connections_by_node[a].end())
+            for (uint32_t v : neighbors(u))
+            {
+                if (rank_[v] <= rank_[u])
+                {
+                    continue;
+                }
+
+                for (uint32_t w : neighbors(v))
+                {
+                    if (mark[w] == u && rank_[w] > rank_[v] && (pred(u) || pred(v) || pred(w)))
                     {
-                        continue;
+                        ++count;
                     }
+                }
+            }
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Returns the nodes of a largest clique.
+     *
+     * Runs Bron-Kerbosch once per node v, in degeneracy order, with v's
+     * later-ranked neighbors as candidates and its earlier ones excluded.
+     * Each of those subproblems works on bitsets over v's neighborhood,
+     * picks Tomita pivots, and keeps its recursion on an explicit stack of
+     * preallocated bitsets, so the search itself never allocates.  Branches
+     * that can't beat the best clique so far are cut off.
+     */
+    vector<uint32_t> max_clique() const
+    {
+        size_t max_words = (max_degree_ + 63) / 64;
+
+        vector<uint32_t> best;
+        vector<uint32_t> clique;
+        vector<uint32_t> local_of(size(), kNone);
+        vector<uint64_t> rows;
+        vector<uint64_t> levels;
+        best.reserve(max_degree_ + 1);
+        clique.reserve(max_degree_ + 1);
+        rows.reserve(max_degree_ * max_words);
+        levels.reserve((max_degree_ + 2) * 3 * max_words);
+
+        for (uint32_t v : order_)
+        {
+            if (best.empty())
+            {
+                best.push_back(v);
+            }
+
+            auto locals = neighbors(v);
+            size_t k = locals.size();
+            size_t num_later = static_cast<size_t>(count_if(locals.begin(), locals.end(), [&](uint32_t u) {
+                return rank_[u] > rank_[v];
+            }));
+            if (num_later + 1 <= best.size())
+            {
+                continue;
+            }
 
-                    if (auto it = connections_by_node[a].find(c); it == connections_by_node[a].end())
+            // Bitset adjacency between v's neighbors, indexed by their
+            // position in v's neighbor list.
+            size_t words = (k + 63) / 64;
+            for (size_t i = 0; i < k; ++i)
+            {
+                local_of[locals[i]] = static_cast<uint32_t>(i);
+            }
+            rows.assign(k * words, 0);
+            for (size_t i = 0; i < k; ++i)
+            {
+                for (uint32_t u : neighbors(locals[i]))
+                {
+                    if (uint32_t j = local_of[u]; j != kNone)
                     {
-                        continue;
+                        rows[i * words + j / 64] |= uint64_t{1} << (j % 64);
                     }
+                }
+            }
+            for (uint32_t u : locals)
+            {
+                local_of[u] = kNone;
+            }
 
-                    if (auto it = connections_by_node[b].find(c); it == connections_by_node[b].end())
+            // Each level of the search has a candidate set P, an excluded
+            // set X, and the candidates T still to branch on.
+            levels.assign((k + 2) * 3 * words, 0);
+            auto P = [&](size_t d) { return levels.data() + (d * 3 + 0) * words; };
+            auto X = [&](size_t d) { return levels.data() + (d * 3 + 1) * words; };
+            auto T = [&](size_t d) { return levels.data() + (d * 3 + 2) * words; };
+            auto row = [&](size_t i) { return rows.data() + i * words; };
+
+            auto choose_pivot = [&](size_t d) {
+                const uint64_t* p = P(d);
+                const uint64_t* x = X(d);
+                size_t best_count = 0;
+                size_t pivot = kNone;
+                for (size_t w = 0; w < words; ++w)
+                {
+                    for (uint64_t bits = p[w] | x[w]; bits != 0; bits &= bits - 1)
                     {
-                        continue;
+                        size_t u = w * 64 + static_cast<size_t>(countr_zero(bits));
+                        const uint64_t* r = row(u);
+                        size_t count = 0;
+                        for (size_t i = 0; i < words; ++i)
+                        {
+                            count += static_cast<size_t>(popcount(p[i] & r[i]));
+                        }
+                        if (pivot == kNone || count > best_count)
+                        {
+                            pivot = u;
+                            best_count = count;
+                        }
                     }
+                }
 
-                    ++num_t_groups;
+                uint64_t* t = T(d);
+                const uint64_t* r = row(pivot);
+                for (size_t w = 0; w < words; ++w)
+                {
+                    t[w] = p[w] & ~r[w];
                 }
+            };
+
+            for (size_t i = 0; i < k; ++i)
+            {
+                uint64_t bit = uint64_t{1} << (i % 64);
+                (rank_[locals[i]] > rank_[v] ? P(0) : X(0))[i / 64] |= bit;
             }
-        }
-    }
+            choose_pivot(0);
 
-    return to_string(num_t_groups);
-}
+            clique.clear();
+            size_t d = 0;
+            while (true)
+            {
+                uint64_t* p = P(d);
+                uint64_t* x = X(d);
+                uint64_t* t = T(d);
 
-using StringSet = unordered_set<string_view>;
+                size_t w = 0;
+                size_t num_candidates = 0;
+                for (size_t i = 0; i < words; ++i)
+                {
+                    num_candidates += static_cast<size_t>(popcount(p[i]));
+                }
+                while (w < words && t[w] == 0)
+                {
+                    ++w;
+                }
 
-void find_cliques(
-    StringSet&& cur,
-    StringSet&& candidates,
-    StringSet&& excluded,
-    unordered_map<string_view, StringSet>& connections_by_node,
-    vector<StringSet>& cliques
-) {
-    if (candidates.empty() && excluded.empty())
-    {
-        cliques.push_back(cur);
-        return;
+                if (w == words || clique.size() + 1 + num_candidates <= best.size())
+                {
+                    if (d == 0)
+                    {
+                        break;
+                    }
+                    --d;
+                    clique.pop_back();
+                    continue;
+                }
+
+                size_t i = w * 64 + static_cast<size_t>(countr_zero(t[w]));
+                uint64_t bit = uint64_t{1} << (i % 64);
+                t[w] &= ~bit;
+
+                const uint64_t* r = row(i);
+                uint64_t* next_p = P(d + 1);
+                uint64_t* next_x = X(d + 1);
+                size_t next_candidates = 0;
+                bool next_excluded = false;
+                for (size_t j = 0; j < words; ++j)
+                {
+                    next_p[j] = p[j] & r[j];
+                    next_x[j] = x[j] & r[j];
+                    next_candidates += static_cast<size_t>(popcount(next_p[j]));
+                    next_excluded |= next_x[j] != 0;
+                }
+                p[w] &= ~bit;
+                x[w] |= bit;
+                clique.push_back(static_cast<uint32_t>(i));
+
+                if (next_candidates == 0)
+                {
+                    if (!next_excluded && clique.size() + 1 > best.size())
+                    {
+                        best.clear();
+                        best.push_back(v);
+                        for (uint32_t j : clique)
+                        {
+                            best.push_back(locals[j]);
+                        }
+                    }
+                    clique.pop_back();
+                    continue;
+                }
+
+                if (clique.size() + 1 + next_candidates <= best.size())
+                {
+                    clique.pop_back();
+                    continue;
+                }
+
+                choose_pivot(d + 1);
+                ++d;
+            }
+        }
+
+        return best;
     }
 
-    while (!candidates.empty())
+private:
+    // Batagelj and Zaversnik's bucket algorithm, O(n + m).
+    void compute_degeneracy_order()
     {
-        auto candidate = *candidates.begin();
+        size_t n = size();
+        vector<size_t> deg(n);
+        vector<size_t> bin(max_degree_ + 1, 0);
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            deg[v] = degree(v);
+            bin[deg[v]]++;
+        }
 
-        StringSet new_cur = cur;
-        new_cur.insert(candidate);
+        size_t start = 0;
+        for (auto& b : bin)
+        {
+            size_t num = b;
+            b = start;
+            start += num;
+        }
 
-        StringSet new_candidates;
-        for (const auto c : candidates)
+        order_.assign(n, 0);
+        rank_.assign(n, 0);
+        for (uint32_t v = 0; v < n; ++v)
         {
-            if (connections_by_node[candidate].find(c) != connections_by_node[candidate].end())
-            {
-                new_candidates.insert(c);
-            }
+            rank_[v] = static_cast<uint32_t>(bin[deg[v]]);
+            order_[rank_[v]] = v;
+            bin[deg[v]]++;
+        }
+        for (size_t d = max_degree_; d > 0; --d)
+        {
+            bin[d] = bin[d - 1];
+        }
+        if (!bin.empty())
+        {
+            bin[0] = 0;
         }
 
-        StringSet new_excluded;
-        for (const auto x : excluded)
+        for (size_t i = 0; i < n; ++i)
         {
-            if (connections_by_node[candidate].find(x) != connections_by_node[candidate].end())
+            uint32_t v = order_[i];
+            for (uint32_t u : neighbors(v))
             {
-                new_excluded.insert(x);
+                if (deg[u] > deg[v])
+                {
+                    // Move u to the front of its bucket, then shrink it
+                    // into the bucket below.
+                    size_t du = deg[u];
+                    size_t pu = rank_[u];
+                    size_t pw = bin[du];
+                    uint32_t w = order_[pw];
+                    if (u != w)
+                    {
+                        order_[pu] = w;
+                        rank_[w] = static_cast<uint32_t>(pu);
+                        order_[pw] = u;
+                        rank_[u] = static_cast<uint32_t>(pw);
+                    }
+                    bin[du]++;
+                    deg[u]--;
+                }
             }
         }
+    }
+};
+
+shared_ptr<const Network> read_network()
+{
+    return input_cache::get(kInputFile, [] {
+        return Network{read_input()};
+    });
+}
 
-        find_cliques(std::move(new_cur), std::move(new_candidates), std::move(new_excluded), connections_by_node, cliques);
+} // namespace
 
-        candidates.erase(candidate);
-        excluded.insert(candidate);
-    }
+string PartOne::solve()
+{
+    const Network& network = *read_network();
+    auto num_t_groups = network.count_triangles([&](uint32_t v) {
+        return network.name(v).starts_with('t');
+    });
+
+    return to_string(num_t_groups);
 }
 
 string PartTwo::solve()
 {
-    auto connections = read_input();
-    unordered_set<string> computers;
-    unordered_map<string_view, StringSet> cxs;
+    const Network& network = *read_network();
 
-    for (const auto& [a, b] : connections)
+    vector<string> max_clique;
+    for (uint32_t v : network.max_clique())
     {
-        auto it_a = computers.insert(a);
-        auto it_b = computers.insert(b);
-
-        cxs[*it_a.first].insert(*it_b.first);
-        cxs[*it_b.first].insert(*it_a.first);
+        max_clique.push_back(network.name(v));
     }
-
-    vector<StringSet> cliques;
-    StringSet vertices(computers.begin(), computers.end());
-    find_cliques({}, std::move(vertices), {}, cxs, cliques);
-
-    auto it = max_element(cliques.begin(), cliques.end(), [](const auto& a, const auto& b) {
-        return a.size() < b.size();
-    });
-
-    vector<string> max_clique(it->begin(), it->end());
     sort(max_clique.begin(), max_clique.end());
 
     stringstream out;
@@ -1,11 +1,18 @@
 #include "base/base.h"
 
+#include "bench.h"
+#include "input_cache.h"
+#include "runner.h"
 #include "solutions.h"
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
 #include <regex>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <fmt/color.h>
 #include <fmt/format.h>
@@ -14,10 +21,55 @@ using namespace std;
 
 regex verbose_arg("-(v+)");
 
+// Per-problem wall times from the last full run, used to schedule the
+// slowest problems first when running in parallel.
+constexpr const char* kTimingsFile = ".aoc2024-timings";
+
+// The problems that a full-suite run covers: those with known answers,
+// or everything when running on example inputs.
+vector<pair<int, int>> suite_keys()
+{
+    vector<pair<int, int>> keys;
+    for (const auto& [key, _] : solutions)
+    {
+        if (g_test_input || expected_answers.contains(key))
+        {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+int run_benchmarks(const vector<pair<int, int>>& keys, size_t warmup, size_t iterations, bench::Format format)
+{
+    vector<bench::Stats> results;
+    int fails = 0;
+    for (const auto& key : keys)
+    {
+        try
+        {
+            results.push_back(bench::measure(key, *solutions[key], warmup, iterations));
+        }
+        catch (const std::exception& e)
+        {
+            fmt::println(stderr, "Day {} Part {}: caught exception: {}", key.first, key.second, e.what());
+            fails++;
+        }
+    }
+
+    bench::print(format, results);
+    return fails;
+}
+
 int main(int argc, char** argv)
 {
     register_solutions();
 
+    size_t jobs = 1;
+    size_t bench_iterations = 0;
+    size_t bench_warmup = 1;
+    bench::Format bench_format = bench::Format::TEXT;
+
     while (argc > 1 && argv[1][0] == '-')
     {
         smatch m;
@@ -31,6 +83,50 @@ int main(int argc, char** argv)
         {
             g_test_input = true;
         }
+        else if ((arg == "-j" || arg == "-b" || arg == "--bench" || arg == "--warmup" || arg == "--format") && argc < 3)
+        {
+            fmt::println(stderr, "Option {} requires an argument", arg);
+            return 1;
+        }
+        else if (arg == "-j")
+        {
+            jobs = stoz(argv[2]);
+            if (jobs == 0)
+            {
+                jobs = max(1u, thread::hardware_concurrency());
+            }
+            argc--;
+            argv++;
+        }
+        else if (arg == "-b" || arg == "--bench")
+        {
+            bench_iterations = stoz(argv[2]);
+            if (bench_iterations == 0)
+            {
+                fmt::println(stderr, "Benchmark iteration count must be positive");
+                return 1;
+            }
+            argc--;
+            argv++;
+        }
+        else if (arg == "--warmup")
+        {
+            bench_warmup = stoz(argv[2]);
+            argc--;
+            argv++;
+        }
+        else if (arg == "--format")
+        {
+            auto format = bench::parse_format(argv[2]);
+            if (!format)
+            {
+                fmt::println(stderr, "Unknown format: {} (expected text, json, or csv)", argv[2]);
+                return 1;
+            }
+            bench_format = *format;
+            argc--;
+            argv++;
+        }
         else
         {
             fmt::println(stderr, "Unknown option: {}", argv[1]);
@@ -41,6 +137,27 @@ int main(int argc, char** argv)
         argv++;
     }
 
+    if (bench_iterations > 0)
+    {
+        vector<pair<int, int>> keys;
+        if (argc == 3)
+        {
+            pair<int, int> key = {stoi(argv[1]), stoi(argv[2])};
+            if (!solutions.contains(key))
+            {
+                fmt::println(stderr, "No problem found for day {} part {}", key.first, key.second);
+                return 1;
+            }
+            keys.push_back(key);
+        }
+        else
+        {
+            keys = suite_keys();
+        }
+
+        return run_benchmarks(keys, bench_warmup, bench_iterations, bench_format);
+    }
+
     if (argc == 3)
     {
         int day = stoi(argv[1]);
@@ -65,33 +182,16 @@ int main(int argc, char** argv)
     }
     else
     {
-        int fails = 0;
-        for (const auto& [key, problem] : solutions)
-        {
-            auto it = expected_answers.find(key);
-            if (it == expected_answers.end() && !g_test_input)
-            {
-                continue;
-            }
-
-            auto expected = g_test_input ? "" : it->second;
+        auto previous_timings = runner::load_timings(kTimingsFile);
 
-            bool did_throw = false;
-            string actual;
-            try
-            {
-                actual = problem->solve();
-            }
-            catch (const std::exception& e)
-            {
-                actual = e.what();
-                did_throw = true;
-            }
+        int fails = 0;
+        auto report = [&](runner::Key key, const runner::Outcome& outcome) {
+            auto expected = g_test_input ? "" : expected_answers[key];
+            const auto& actual = outcome.answer;
 
-            bool passed = !did_throw && actual == expected;
+            bool passed = !outcome.did_throw && actual == expected;
 
             string message = passed ? "[PASS]" : "[FAIL]";
-            string clear = "\033[0m";
             string expected_message = " (expected " + expected + ")";
 
             if (g_test_input)
@@ -115,8 +215,24 @@ int main(int argc, char** argv)
                 actual,
                 expected_message
             );
+        };
+
+        auto timings = runner::solve_all(suite_keys(), jobs, previous_timings, report);
+
+        if (!g_test_input)
+        {
+            runner::save_timings(kTimingsFile, timings);
         }
 
+        auto cache = input_cache::stats();
+        fmt::println(
+            "Input cache: {} parses, {} reuses, {:.3f} ms spent parsing, ~{:.3f} ms avoided by reuse",
+            cache.misses,
+            cache.hits,
+            chrono::duration<double, milli>(cache.parse_time).count(),
+            chrono::duration<double, milli>(cache.saved_time).count()
+        );
+
         return fails;
     }
 
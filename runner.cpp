@@ -0,0 +1,137 @@
+#include "runner.h"
+
+#include "solutions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+using namespace std;
+
+namespace runner
+{
+
+namespace
+{
+
+using Clock = chrono::steady_clock;
+
+Outcome solve_one(Problem& problem)
+{
+    auto start = Clock::now();
+    Outcome outcome{"", false, {}};
+    try
+    {
+        outcome.answer = problem.solve();
+    }
+    catch (const std::exception& e)
+    {
+        outcome.answer = e.what();
+        outcome.did_throw = true;
+    }
+    outcome.elapsed = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start);
+    return outcome;
+}
+
+} // namespace
+
+Timings solve_all(
+    const vector<Key>& keys,
+    size_t jobs,
+    const Timings& previous,
+    const function<void(Key, const Outcome&)>& report)
+{
+    // Longest-processing-time-first: given the same set of jobs, this keeps
+    // the overall wall time close to that of the slowest single job.
+    vector<size_t> schedule(keys.size());
+    iota(schedule.begin(), schedule.end(), 0);
+    auto expected_cost = [&](size_t ix) {
+        auto it = previous.find(keys[ix]);
+        return it == previous.end() ? chrono::nanoseconds::max() : it->second;
+    };
+    stable_sort(schedule.begin(), schedule.end(), [&](size_t a, size_t b) {
+        return expected_cost(a) > expected_cost(b);
+    });
+
+    vector<optional<Outcome>> outcomes(keys.size());
+    mutex mtx;
+    condition_variable cv;
+    atomic<size_t> next_job{0};
+
+    auto worker = [&]() {
+        for (size_t n = next_job++; n < schedule.size(); n = next_job++)
+        {
+            size_t ix = schedule[n];
+            auto outcome = solve_one(*solutions.at(keys[ix]));
+
+            lock_guard lock{mtx};
+            outcomes[ix] = std::move(outcome);
+            cv.notify_one();
+        }
+    };
+
+    if (jobs <= 1)
+    {
+        // No helper threads; solve in order on this thread.
+        for (size_t ix = 0; ix < keys.size(); ++ix)
+        {
+            outcomes[ix] = solve_one(*solutions.at(keys[ix]));
+            report(keys[ix], *outcomes[ix]);
+        }
+    }
+    else
+    {
+        vector<jthread> workers;
+        for (size_t i = 0; i < min(jobs, keys.size()); ++i)
+        {
+            workers.emplace_back(worker);
+        }
+
+        for (size_t ix = 0; ix < keys.size(); ++ix)
+        {
+            unique_lock lock{mtx};
+            cv.wait(lock, [&] { return outcomes[ix].has_value(); });
+            lock.unlock();
+
+            report(keys[ix], *outcomes[ix]);
+        }
+    }
+
+    Timings timings;
+    for (size_t ix = 0; ix < keys.size(); ++ix)
+    {
+        timings[keys[ix]] = outcomes[ix]->elapsed;
+    }
+    return timings;
+}
+
+Timings load_timings(const string& path)
+{
+    Timings timings;
+    ifstream in{path};
+
+    int day, part;
+    long long ns;
+    while (in >> day >> part >> ns)
+    {
+        timings[{day, part}] = chrono::nanoseconds{ns};
+    }
+    return timings;
+}
+
+void save_timings(const string& path, const Timings& timings)
+{
+    ofstream out{path};
+    for (const auto& [key, elapsed] : timings)
+    {
+        out << key.first << ' ' << key.second << ' ' << elapsed.count() << '\n';
+    }
+}
+
+} // namespace runner
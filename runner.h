@@ -0,0 +1,52 @@
+#pragma once
+
+#include "base.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace runner
+{
+
+using Key = std::pair<int, int>;
+
+struct Outcome
+{
+    std::string answer;
+    bool did_throw;
+    std::chrono::nanoseconds elapsed;
+};
+
+using Timings = std::map<Key, std::chrono::nanoseconds>;
+
+/**
+ * @brief Solves each of the given problems, using up to `jobs` threads.
+ *
+ * Problems are started longest-first according to `previous` (problems with
+ * no recorded timing are assumed to be slow and go first), but `report` is
+ * always invoked on the calling thread in the order that `keys` are given,
+ * as soon as each result and all those before it are available.
+ *
+ * @return the wall time taken by each problem in this run.
+ */
+Timings solve_all(
+    const std::vector<Key>& keys,
+    std::size_t jobs,
+    const Timings& previous,
+    const std::function<void(Key, const Outcome&)>& report
+);
+
+/**
+ * @brief Reads timings saved by a previous run; missing or malformed files
+ *        yield an empty result.
+ */
+Timings load_timings(const std::string& path);
+
+void save_timings(const std::string& path, const Timings& timings);
+
+} // namespace runner